@@ -1,7 +1,12 @@
 #include <cmath>
+#include <cstdint>
 #include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
 #include <regex>
+#include <thread>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/gil/image.hpp>
@@ -9,8 +14,14 @@
 #include <boost/gil/extension/io/pnm.hpp>
 #include <boost/program_options.hpp>
 #include <CGAL/squared_distance_2.h>
+#include <fcntl.h>
+#include <unistd.h>
 
+#include "growth/export.hpp"
+#include "growth/trace.hpp"
 #include "img.hpp"
+#include "raster.hpp"
+#include "render.hpp"
 
 #include "app.hpp"
 
@@ -33,6 +44,7 @@ int App::parse_options(int argc, const char* argv[]) {
     unsigned int height = venation_.height();
     boost::gil::rgb8_image_t mask_img;
     bool valid_mask_provided = false;
+    unsigned long expand_steps = 0;
     
     // parse command line options
     try {
@@ -45,6 +57,26 @@ int App::parse_options(int argc, const char* argv[]) {
                 "Simulation height in pixels. Defaults to 512, overridden by mask.")
             ("num-attractors", po::value<unsigned int>(),
                 "Number of random attractors to generate. Defaults to 1000.")
+            ("placement", po::value<std::string>(),
+                "How the attractors are spread, 'random' or 'poisson'. "
+                "Poisson places about `num-attractors` evenly spaced "
+                "attractors, no two closer than a radius that shrinks with "
+                "the mask's brightness, so fewer attractors and steps give "
+                "the same density of veins. Defaults to 'random'.")
+            ("expand-steps", po::value<unsigned long>(),
+                "Grow the leaf blade about the center from nothing to its "
+                "full size over this many steps, adding attractors as it "
+                "grows instead of placing them all up front. Each step "
+                "scatters `num-attractors` divided by it candidates over the "
+                "blade. Defaults to 0, which disables it.")
+            ("birth-radius", po::value<double>(),
+                "With `expand-steps`, the distance to a node or another "
+                "attractor within which a new attractor is dropped "
+                "(relative to normalized points). Defaults to 0.02.")
+            ("seed", po::value<std::uint64_t>(),
+                "The seed every random number is drawn from. The same seed "
+                "and options give the same result on any machine and with "
+                "any number of threads. Defaults to 0.")
             ("seeds", po::value<std::string>(),
                 "A list of 2D points to start growing from. Input should be of "
                 "the form \"(x1,y2),...,(xn,yn)\" where each x and y is in "
@@ -55,15 +87,42 @@ int App::parse_options(int argc, const char* argv[]) {
             ("timeout", po::value<unsigned int>(),
                 "A time limit in seconds after which the simulation result "
                 "will be saved to the output file, if present, and the program "
-                "will terminate. Defaults to 60 seconds.")
-            ("growth-radius", po::value<long double>(),
+                "will terminate. Defaults to 60 seconds, or no limit when "
+                "--max-steps or --until-converged is given. 0 disables it.")
+            ("max-steps", po::value<unsigned long>(),
+                "A number of simulation steps after which the result will be "
+                "saved to the output file, if present, and the program will "
+                "terminate. Unlike the timeout this does not depend on the "
+                "speed of the machine.")
+            ("until-converged",
+                "Run until the simulation converges, that is every attractor "
+                "has been consumed or no growth has occurred for more than "
+                "`no-growth-limit` consecutive steps, then save the result "
+                "and terminate.")
+            ("no-growth-limit", po::value<unsigned int>(),
+                "The number of consecutive steps without growth after which "
+                "the simulation is considered converged. Defaults to 8.")
+            ("index", po::value<std::string>(),
+                "Spatial index used to find the growth nodes closest to the "
+                "attractors, 'delaunay' or 'grid'. The grid is faster for "
+                "large runs and lets closed venation use several threads. "
+                "Defaults to 'delaunay'.")
+            ("defer-pruning",
+                "Keep every node during the simulation and only prune "
+                "straight lines of nodes when the result is saved. This "
+                "changes the result as pruned nodes no longer attract growth.")
+            ("threads", po::value<unsigned int>(),
+                "The number of threads used to associate attractors with "
+                "growth nodes. The result does not depend on it. Defaults to "
+                "0, which uses every available core.")
+            ("growth-radius", po::value<double>(),
                 "The maximum distance an attractor can be from a growth node "
                 "and still influence it (relative to normalized points). "
                 "Defaults to 0.5.")
-            ("growth-rate", po::value<long double>(),
+            ("growth-rate", po::value<double>(),
                 "The size of the step taken at each growth step (relative to "
                 "normalized points). Defaults to 0.002.")
-            ("consume-radius", po::value<long double>(),
+            ("consume-radius", po::value<double>(),
                 "The distance between an attractor and node at which point "
                 "the attractor is considered consumed and removed "
                 "(relative to normalized points). Defaults to 0.002.")
@@ -72,15 +131,50 @@ int App::parse_options(int argc, const char* argv[]) {
                 "Defaults to 2.")
             ("mask", po::value<std::string>(),
                 "A path to a pnm image file that will be used to mask "
-                "the attractors. i.e. generated attractors will only be kept "
-                "for the simulation if the corresponding pixel in the image "
-                "is bright enough. Simple, black and white images are best."
-                "The file is converted to grayscale and quantized into "
-                "`mask-shades` shades. The grayscale value is then used as a "
-                "probability that an attractor at that position will be kept.")
+                "the attractors. i.e. attractors are only placed in the "
+                "pixels of the image that are bright enough. Simple, black "
+                "and white images are best. The file is converted to "
+                "grayscale and quantized into `mask-shades` shades. The "
+                "attractors are then spread over the pixels in proportion to "
+                "their grayscale value, so every one of `num-attractors` "
+                "lands in the mask.")
             ("outfile", po::value<std::string>(), 
-                "An image path to store the result at. The path must include "
-                "an extension and it must be pnm.");
+                "A path to store the result at. The path must include an "
+                "extension, pnm for an image, svg for a vector drawing of "
+                "the tree keeping every node's width, or edges for a binary "
+                "list of the nodes' positions, widths and parents, see "
+                "growth/export.hpp. Both are written from the tree, not the "
+                "screen, so they are not limited to the window's size.")
+            ("scale", po::value<double>(),
+                "Draw the pnm outfile this many times the simulation's size, "
+                "widths included, e.g. 32 for a 16384 pixel square from a "
+                "512 pixel simulation. It is drawn in tiles on `threads` "
+                "threads and written out as they finish, so neither the "
+                "screen nor memory limits its size. Defaults to 1, which "
+                "with a window saves the window's frame.")
+            ("trace", po::value<std::string>(),
+                "A path to write a trace of each step's time per phase and "
+                "counts to. A .csv extension writes CSV, .json a Chrome "
+                "trace with an event per phase, anything else a JSON object "
+                "per line. Only available when built with GROWTH_TRACE.")
+            ("checkpoint", po::value<std::string>(),
+                "A path to periodically save the whole state of the "
+                "simulation to, and once more when it ends, so it can be "
+                "continued with `resume`. Written in the background without "
+                "pausing the simulation.")
+            ("checkpoint-interval", po::value<unsigned int>(),
+                "The time in seconds between checkpoints. Defaults to 300.")
+            ("resume", po::value<std::string>(),
+                "A checkpoint to continue the simulation from, exactly as it "
+                "would have carried on. Its options and mask replace the "
+                "simulation options given, except `threads`, and "
+                "`expand-steps` which must be given again with the same "
+                "`num-attractors`. Steps count on from the checkpoint's.")
+            ("headless",
+                "Run without a window, stepping the simulation as fast as "
+                "possible. The result is drawn with a software rasterizer "
+                "at the full simulation size instead of being read back "
+                "from the screen.");
 
         po::variables_map vm;
         po::store(po::parse_command_line(argc, argv, desc), vm);
@@ -94,6 +188,10 @@ int App::parse_options(int argc, const char* argv[]) {
             return EXIT_FAILURE;
         }
 
+        if (vm.count("headless")) {
+            headless_ = true;
+        }
+
         if (vm.count("width")) {
             width = vm["width"].as<unsigned int>();
         }
@@ -106,6 +204,10 @@ int App::parse_options(int argc, const char* argv[]) {
             venation_.num_attractors(vm["num-attractors"].as<unsigned int>());
         }
 
+        if (vm.count("seed")) {
+            venation_.random_seed(vm["seed"].as<std::uint64_t>());
+        }
+
         if (vm.count("seeds")) {
             std::vector<venation::point2> seeds;
 
@@ -165,20 +267,83 @@ int App::parse_options(int argc, const char* argv[]) {
             venation_.mode(vm["mode"].as<std::string>());
         }
 
+        if (vm.count("max-steps")) {
+            max_steps_ = vm["max-steps"].as<unsigned long>();
+        }
+
+        if (vm.count("until-converged")) {
+            until_converged_ = true;
+        }
+
+        if (vm.count("no-growth-limit")) {
+            venation_.no_growth_limit(vm["no-growth-limit"].as<unsigned int>());
+        }
+
+        if (vm.count("placement")) {
+            auto placement = vm["placement"].as<std::string>();
+            if (placement != "random" && placement != "poisson") {
+                std::cerr << "Error: invalid placement '" << placement
+                    << "', expected random or poisson.\n";
+                return EXIT_FAILURE;
+            }
+            venation_.placement(placement);
+        }
+
+        if (vm.count("expand-steps")) {
+            expand_steps = vm["expand-steps"].as<unsigned long>();
+        }
+
+        if (vm.count("birth-radius")) {
+            venation_.birth_radius(vm["birth-radius"].as<double>());
+        }
+
+        if (vm.count("index")) {
+            auto index = vm["index"].as<std::string>();
+            if (index != "delaunay" && index != "grid") {
+                std::cerr << "Error: invalid index '" << index
+                    << "', expected delaunay or grid.\n";
+                return EXIT_FAILURE;
+            }
+            venation_.index(index);
+        }
+
+        if (vm.count("defer-pruning")) {
+            venation_.defer_pruning(true);
+            defer_pruning_ = true;
+        }
+
+        if (vm.count("threads")) {
+            threads_ = vm["threads"].as<unsigned int>();
+            venation_.threads(threads_);
+        }
+
+        if (vm.count("scale")) {
+            scale_ = vm["scale"].as<double>();
+            if (!(scale_ > 0.0)) {
+                std::cerr << "Error: invalid scale " << scale_
+                    << ", expected a number greater than 0.\n";
+                return EXIT_FAILURE;
+            }
+        }
+
+        // step based termination replaces the wall clock timeout
+        // unless one is explicitly requested
         if (vm.count("timeout")) {
             timeout_ = vm["timeout"].as<unsigned int>();
+        } else if (max_steps_ > 0 || until_converged_) {
+            timeout_ = 0;
         }
 
         if (vm.count("growth-radius")) {
-            venation_.growth_radius(vm["growth-radius"].as<long double>());
+            venation_.growth_radius(vm["growth-radius"].as<double>());
         }
 
         if (vm.count("growth-rate")) {
-            venation_.growth_rate(vm["growth-rate"].as<long double>());
+            venation_.growth_rate(vm["growth-rate"].as<double>());
         }
 
         if (vm.count("consume-radius")) {
-            venation_.consume_radius(vm["consume-radius"].as<long double>());
+            venation_.consume_radius(vm["consume-radius"].as<double>());
         }
 
         if (vm.count("mask-shades")) {
@@ -224,7 +389,7 @@ int App::parse_options(int argc, const char* argv[]) {
 
             if (parts.size() < 2) {
                 std::cerr << "Error invalid outfile '" << out_file
-                    << "', expected a path with a pnm extension.\n";
+                    << "', expected a path with a pnm, svg or edges extension.\n";
                 return EXIT_FAILURE;
             }
 
@@ -236,20 +401,61 @@ int App::parse_options(int argc, const char* argv[]) {
             const char* ext = extension.c_str();
 
             // validate extension
-            if (strcmp(ext, "pnm") != 0) {
+            if (strcmp(ext, "pnm") != 0 && strcmp(ext, "svg") != 0
+                    && strcmp(ext, "edges") != 0) {
                 std::cerr << "Error: invalid outfile extension '" << extension 
-                    << "', expected pnm.\n";
+                    << "', expected pnm, svg or edges.\n";
                 return EXIT_FAILURE;
             }
 
             out_file_ = out_file;
+            out_format_ = extension;
+        }
+
+        if (vm.count("trace")) {
+            if (!trace::enabled) {
+                std::cerr << "Error: tracing was not built in, configure "
+                    << "with -DGROWTH_TRACE=ON to use --trace.\n";
+                return EXIT_FAILURE;
+            }
+
+            trace_file_ = vm["trace"].as<std::string>();
+        }
+
+        if (vm.count("checkpoint")) {
+            checkpoint_file_ = vm["checkpoint"].as<std::string>();
+        }
+
+        if (vm.count("checkpoint-interval")) {
+            checkpoint_interval_ = vm["checkpoint-interval"].as<unsigned int>();
+        }
+
+        if (vm.count("resume")) {
+            checkpoint_.read(vm["resume"].as<std::string>());
+            resume_ = true;
         }
     } catch (const po::error &ex) {
         std::cerr << ex.what() << '\n';
         return EXIT_FAILURE;
+    } catch (const std::runtime_error& ex) {
+        std::cerr << "Error: " << ex.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    if (expand_steps > 0) {
+        // the attractors are spread over the steps, drawn from the seed
+        // the simulation was started with when resuming
+        unsigned int per_step = (venation_.num_attractors() + expand_steps - 1) / expand_steps;
+        std::uint64_t seed = resume_ ? checkpoint_.params.seed : venation_.random_seed();
+        venation_.source(std::make_unique<expanding_source<default_kernel>>(
+            expand_steps, per_step, seed));
+        venation_.num_attractors(0);
     }
 
-    if (valid_mask_provided) {
+    if (resume_) {
+        // the window is sized for the checkpoint's simulation
+        venation_.configure(checkpoint_.params.width, checkpoint_.params.height);
+    } else if (valid_mask_provided) {
         venation_.mask(mask_img);
     } else {
         venation_.configure(width, height);
@@ -259,15 +465,45 @@ int App::parse_options(int argc, const char* argv[]) {
 }
 
 void App::scale_to_fit(int window_width, int window_height) {
+    fit_width_ = window_width;
+    fit_height_ = window_height;
     venation_.scale_to_fit(window_width, window_height);
 }
 
 void App::setup() {
-    venation_.setup();
+    if (!trace_file_.empty()) {
+        // pick the format from the extension
+        auto extension = std::filesystem::path(trace_file_).extension().string();
+        std::for_each(extension.begin(), extension.end(), [](char & c){
+            c = ::tolower(c);
+        });
+
+        auto format = trace::format::json_lines;
+        if (extension == ".csv") {
+            format = trace::format::csv;
+        } else if (extension == ".json") {
+            format = trace::format::chrome;
+        }
 
-    if (timeout_ > 0.0) {
-        start_ = std::chrono::system_clock::now();
+        if (!trace::open(trace_file_, format)) {
+            std::cerr << "Error: could not write the trace to '" << trace_file_ << "'\n";
+        }
     }
+
+    if (resume_) {
+        // loading restores the checkpoint's size, fit it to the window
+        // again so it is drawn at the window's
+        venation_.load(checkpoint_);
+        defer_pruning_ = checkpoint_.params.defer_pruning != 0;
+        if (fit_width_ > 0) {
+            venation_.scale_to_fit(fit_width_, fit_height_);
+        }
+    } else {
+        venation_.setup();
+    }
+
+    start_ = std::chrono::system_clock::now();
+    last_checkpoint_ = start_;
 }
 
 void App::check_timeout() {
@@ -282,37 +518,216 @@ void App::check_timeout() {
     double timeout = (double)timeout_;
 
     if (running_time >= (double)timeout_) {
-        if (!out_file_.empty()) {
-            img::save_frame(out_file_, window_);
+        done_ = true;
+    }
+}
+
+void App::check_steps() {
+    if (max_steps_ > 0 && venation_.steps() >= max_steps_) {
+        done_ = true;
+    }
+
+    if (until_converged_ && venation_.converged()) {
+        done_ = true;
+    }
+}
+
+void App::save() {
+    if (out_file_.empty()) {
+        return;
+    }
+
+    if (out_format_ == "svg" || out_format_ == "edges") {
+        int fd = ::open(out_file_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "Error: could not write the output to '" << out_file_ << "'\n";
+            return;
+        }
+
+        try {
+            if (out_format_ == "svg") {
+                exporters::write_svg(fd, venation_);
+            } else {
+                exporters::write_edges(fd, venation_);
+            }
+            std::cout << "Output written to " << out_file_ << '\n';
+        } catch (const std::runtime_error& ex) {
+            std::cerr << "Error: " << ex.what() << '\n';
         }
 
-        exit(EXIT_SUCCESS);
+        ::close(fd);
+        return;
+    }
+
+    if (!headless_ && scale_ == 1.0) {
+        render::save_frame(out_file_, window_);
+        return;
+    }
+
+    std::cout << "Rendering frame...\n";
+    std::ofstream out(out_file_, std::ios::binary);
+    raster::render_tiled(venation_, out, scale_, threads_, show_attractors_);
+    out.close();
+
+    if (!out) {
+        std::cerr << "Error: could not write the output to '" << out_file_ << "'\n";
+        return;
+    }
+    std::cout << "Output written to " << out_file_ << '\n';
+}
+
+/**
+ * Starts writing a checkpoint once the interval has passed since the
+ * last one, unless that one is still being written. Only copying the
+ * state holds up the simulation.
+ */
+void App::check_checkpoint() {
+    if (checkpoint_file_.empty() || done_
+            || (checkpoint_writer_.joinable() && !checkpoint_written_)) {
+        return;
+    }
+
+    auto now = std::chrono::system_clock::now();
+    if (now - last_checkpoint_ < std::chrono::seconds(checkpoint_interval_)) {
+        return;
+    }
+
+    if (checkpoint_writer_.joinable()) {
+        checkpoint_writer_.join();
+    }
+
+    last_checkpoint_ = now;
+    venation_.save(checkpoint_);
+    checkpoint_written_ = false;
+    checkpoint_writer_ = std::thread([this]() {
+        try {
+            checkpoint_.write(checkpoint_file_);
+        } catch (const std::runtime_error& ex) {
+            std::cerr << "Error: " << ex.what() << '\n';
+        }
+        checkpoint_written_ = true;
+    });
+}
+
+/**
+ * Waits for a checkpoint being written, then writes the current state.
+ */
+void App::write_checkpoint() {
+    if (checkpoint_writer_.joinable()) {
+        checkpoint_writer_.join();
+    }
+
+    if (checkpoint_file_.empty()) {
+        return;
+    }
+
+    try {
+        venation_.save(checkpoint_);
+        checkpoint_.write(checkpoint_file_);
+        std::cout << "Checkpoint written to " << checkpoint_file_ << '\n';
+    } catch (const std::runtime_error& ex) {
+        std::cerr << "Error: " << ex.what() << '\n';
     }
 }
 
+void App::finish() {
+    // saved before pruning, which changes how the simulation would go on
+    write_checkpoint();
+
+    if (!done_) {
+        trace::close();
+        return;
+    }
+
+    // report the amount of work done
+    auto steps = venation_.steps();
+    std::chrono::duration<double> total = std::chrono::system_clock::now() - start_;
+    std::cout << "Finished after " << steps << " steps in " << total.count()
+        << " s";
+    if (steps > 0) {
+        std::cout << ", " << step_time_.count() * 1000.0 / steps
+            << " ms per step";
+    }
+    std::cout << '\n';
+
+    if (defer_pruning_) {
+        venation_.optimize();
+    }
+
+    save();
+    trace::close();
+}
+
 void App::update() {
     check_timeout();
 
-    if (!running_) {
+    if (!running_ || done_) {
         return;
     }
 
+    auto start = std::chrono::system_clock::now();
     venation_.update();
+    step_time_ += std::chrono::system_clock::now() - start;
+
+    check_steps();
+    check_checkpoint();
 }
 
-void App::draw() {
-    if (!running_) {
-        return;
+void App::start() {
+    publish();
+    simulation_ = std::thread(&App::simulate, this);
+}
+
+void App::stop() {
+    stopping_ = true;
+    if (simulation_.joinable()) {
+        simulation_.join();
     }
 
+    publish();
+}
+
+/**
+ * Steps the simulation until it is done or stopped. A snapshot is only
+ * taken once the last one has been drawn, so copying the state costs at
+ * most once per frame.
+ */
+void App::simulate() {
+    while (!stopping_ && !done_) {
+        if (!running_) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+
+        update();
+
+        if (snapshots_.consumed()) {
+            publish();
+        }
+    }
+}
+
+/**
+ * Hands a snapshot of the simulation's current state to the renderer.
+ */
+void App::publish() {
+    venation_.capture(snapshots_.back(), show_attractors_);
+    snapshots_.publish();
+}
+
+void App::draw() {
+    GROWTH_TRACE_SCOPE(draw);
+    snapshots_.update();
+    const auto& s = snapshots_.front();
+
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     if (show_attractors_) {
-        venation_.draw_attractors();
+        render::draw_attractors(s);
     }
 
-    venation_.draw_nodes();
+    render::draw_nodes(s);
 
     glFlush();
 }
@@ -40,10 +40,24 @@ int main(int argc, const char* argv[]) {
         return r;
     }
 
+    if (app.headless()) {
+        // no window, step the simulation as fast as possible
+        std::cout << "setting up simulation\n";
+        app.setup();
+
+        std::cout << "running headless\n";
+        while (!app.done()) {
+            app.update();
+        }
+
+        app.finish();
+
+        return EXIT_SUCCESS;
+    }
+
     // initialize openGL app
     std::cout << "initializing\n";
     if (!glfwInit()) { return EXIT_FAILURE; }
-    glfwSwapInterval(1);
 
     std::cout << "scaling to fit\n";
     const GLFWvidmode* mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
@@ -58,24 +72,32 @@ int main(int argc, const char* argv[]) {
         return EXIT_FAILURE;
     }
 
-    // setup callbacks
+    // setup callbacks, drawing is synced to the display
     glfwSetKeyCallback(window, key_callback);
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(1);
 
     // setup app
     std::cout << "setting up simulation\n";
     app.window(window);
     app.setup();
     
-    // animate
+    // animate, the simulation steps on its own thread meanwhile
     std::cout << "animating\n";
-    while (!glfwWindowShouldClose(window)) {
-        app.update();
+    app.start();
+    while (!glfwWindowShouldClose(window) && !app.done()) {
         glfwMakeContextCurrent(window);
         app.draw();
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    // draw the final state, which is the frame saved
+    app.stop();
+    app.draw();
+    glfwSwapBuffers(window);
+
+    app.finish();
     glfwTerminate();
 
     return EXIT_SUCCESS;
@@ -0,0 +1,471 @@
+/**
+ * Runs many simulations from a job file, several at once, each on a
+ * single thread of a shared pool. Every line of the job file is one
+ * simulation, given as space separated key=value pairs named after the
+ * venation options, for example:
+ *
+ *     mode=closed mask=masks/circle_mask.pnm seed=3 num-attractors=5000 outfile=circle_3.pnm
+ *
+ * Blank lines and lines starting with '#' are skipped. Each mask is read
+ * once and shared by the jobs using it. A job's image is written as soon
+ * as it has finished, and a JSON object with its results printed on its
+ * own line, in the order the jobs finish.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/gil/image.hpp>
+#include <boost/gil/typedefs.hpp>
+#include <boost/gil/extension/io/pnm.hpp>
+#include <boost/program_options.hpp>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "growth/export.hpp"
+#include "growth/thread_pool.hpp"
+#include "growth/venation.hpp"
+#include "raster.hpp"
+
+namespace po = boost::program_options;
+
+using namespace growth;
+
+namespace {
+
+    using mask_ptr = std::shared_ptr<const boost::gil::rgb8_image_t>;
+
+    const std::set<std::string> keys = {
+        "mode", "index", "placement", "num-attractors", "seed", "seeds",
+        "width", "height", "mask", "mask-shades", "growth-radius",
+        "growth-rate", "consume-radius", "no-growth-limit", "max-steps",
+        "outfile", "scale"
+    };
+
+    struct job {
+        // the line of the job file it was read from
+        unsigned int line = 0;
+        std::map<std::string, std::string> options;
+
+        std::string get(const std::string& key, const std::string& otherwise = "") const {
+            auto it = options.find(key);
+            return it == options.end() ? otherwise : it->second;
+        }
+    };
+
+    struct settings {
+        std::string index = "grid";
+        unsigned long max_steps = 0;
+    };
+
+    unsigned long to_unsigned(const std::string& key, const std::string& value) {
+        std::size_t end = 0;
+        unsigned long n = 0;
+        try {
+            n = std::stoul(value, &end);
+        } catch (const std::exception&) {}
+
+        if (end == 0 || end != value.size() || value[0] == '-') {
+            throw std::invalid_argument("expected a whole number for " + key
+                + ", got '" + value + "'");
+        }
+
+        return n;
+    }
+
+    double to_double(const std::string& key, const std::string& value) {
+        std::size_t end = 0;
+        double d = 0.0;
+        try {
+            d = std::stod(value, &end);
+        } catch (const std::exception&) {}
+
+        if (end == 0 || end != value.size()) {
+            throw std::invalid_argument("expected a number for " + key
+                + ", got '" + value + "'");
+        }
+
+        return d;
+    }
+
+    /**
+     * Returns the value if it is one of the choices.
+     */
+    std::string to_choice(const std::string& key, const std::string& value,
+            std::initializer_list<const char*> choices) {
+        std::string expected;
+        for (auto choice : choices) {
+            if (value == choice) {
+                return value;
+            }
+            expected += (expected.empty() ? "'" : " or '") + std::string(choice) + "'";
+        }
+
+        throw std::invalid_argument("expected " + expected + " for " + key
+            + ", got '" + value + "'");
+    }
+
+    /**
+     * Quotes the text as a JSON string.
+     */
+    std::string to_json(const std::string& text) {
+        std::string quoted = "\"";
+        for (unsigned char c : text) {
+            if (c == '"' || c == '\\') {
+                quoted += '\\';
+                quoted += c;
+            } else if (c < 0x20) {
+                char escape[8];
+                std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+                quoted += escape;
+            } else {
+                quoted += c;
+            }
+        }
+        return quoted + "\"";
+    }
+
+    /**
+     * Returns the path's extension in lowercase, empty if it has none.
+     */
+    std::string extension(const std::string& path) {
+        auto dot = path.rfind('.');
+        if (dot == std::string::npos || path.find('/', dot) != std::string::npos) {
+            return "";
+        }
+
+        auto ext = path.substr(dot + 1);
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        return ext;
+    }
+
+    /**
+     * Parses seeds of the form "(x1,y1),...,(xn,yn)".
+     */
+    std::vector<venation::point2> to_seeds(const std::string& value) {
+        std::string number = "([+-]?(?:[0-9]*[.])?[0-9]+)";
+        std::regex point("\\(" + number + "," + number + "\\)");
+        std::regex list("^\\(" + number + "," + number + "\\)(,\\(" + number
+            + "," + number + "\\))*$");
+
+        if (!std::regex_match(value, list)) {
+            throw std::invalid_argument("expected seeds of the form "
+                "(x1,y1),...,(xn,yn), got '" + value + "'");
+        }
+
+        std::vector<venation::point2> seeds;
+        for (std::sregex_iterator it(value.begin(), value.end(), point), end;
+                it != end; ++it) {
+            seeds.push_back(venation::point2(std::stod((*it)[1]), std::stod((*it)[2])));
+        }
+
+        return seeds;
+    }
+
+    /**
+     * Reads the jobs from the file, failing on the first invalid line.
+     */
+    std::vector<job> read_jobs(std::istream& in) {
+        std::vector<job> jobs;
+        std::string text;
+        unsigned int line = 0;
+
+        while (std::getline(in, text)) {
+            ++line;
+
+            std::istringstream tokens(text);
+            std::string token;
+            job j;
+            j.line = line;
+
+            while (tokens >> token) {
+                if (j.options.empty() && token[0] == '#') {
+                    break;
+                }
+
+                auto equals = token.find('=');
+                if (equals == std::string::npos || equals == 0) {
+                    throw std::invalid_argument("line " + std::to_string(line)
+                        + ": expected key=value, got '" + token + "'");
+                }
+
+                auto key = token.substr(0, equals);
+                if (keys.count(key) == 0) {
+                    throw std::invalid_argument("line " + std::to_string(line)
+                        + ": unknown key '" + key + "'");
+                }
+
+                j.options[key] = token.substr(equals + 1);
+            }
+
+            if (!j.options.empty()) {
+                jobs.push_back(j);
+            }
+        }
+
+        return jobs;
+    }
+
+    /**
+     * Configures the simulation for the job. The size, from the mask if
+     * any, is set first as the seeds are scaled by it.
+     */
+    void configure(venation& v, const job& j, const settings& s,
+            const std::map<std::string, mask_ptr>& masks) {
+        auto mask = j.get("mask");
+        if (!mask.empty()) {
+            v.mask(masks.at(mask));
+        } else {
+            v.configure(to_unsigned("width", j.get("width", "512")),
+                to_unsigned("height", j.get("height", "512")));
+        }
+
+        v.mode(to_choice("mode", j.get("mode", "open"), { "open", "closed" }))
+            .index(to_choice("index", j.get("index", s.index), { "delaunay", "grid" }))
+            .placement(to_choice("placement", j.get("placement", "random"),
+                { "random", "poisson" }))
+            .threads(1);
+
+        for (const auto& option : j.options) {
+            const auto& key = option.first;
+            const auto& value = option.second;
+
+            if (key == "num-attractors") {
+                v.num_attractors(to_unsigned(key, value));
+            } else if (key == "seed") {
+                v.random_seed(to_unsigned(key, value));
+            } else if (key == "seeds") {
+                v.seeds(to_seeds(value));
+            } else if (key == "mask-shades") {
+                v.mask_shades(to_unsigned(key, value));
+            } else if (key == "growth-radius") {
+                v.growth_radius(to_double(key, value));
+            } else if (key == "growth-rate") {
+                v.growth_rate(to_double(key, value));
+            } else if (key == "consume-radius") {
+                v.consume_radius(to_double(key, value));
+            } else if (key == "no-growth-limit") {
+                v.no_growth_limit(to_unsigned(key, value));
+            }
+        }
+    }
+
+    /**
+     * Runs the job to convergence, or to its step limit, writes its image
+     * if it has an outfile, and returns its results as a line of JSON.
+     */
+    std::string run(const job& j, const settings& s,
+            const std::map<std::string, mask_ptr>& masks) {
+        auto start = std::chrono::steady_clock::now();
+
+        venation v;
+        configure(v, j, s, masks);
+        unsigned long max_steps = j.options.count("max-steps")
+            ? to_unsigned("max-steps", j.get("max-steps")) : s.max_steps;
+
+        v.setup();
+        while (!v.converged() && (max_steps == 0 || v.steps() < max_steps)) {
+            v.update();
+        }
+
+        auto outfile = j.get("outfile");
+        auto format = extension(outfile);
+        if (format == "svg" || format == "edges") {
+            int fd = ::open(outfile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) {
+                throw std::runtime_error("could not write '" + outfile + "'");
+            }
+
+            try {
+                if (format == "svg") {
+                    exporters::write_svg(fd, v);
+                } else {
+                    exporters::write_edges(fd, v);
+                }
+            } catch (...) {
+                ::close(fd);
+                throw;
+            }
+            ::close(fd);
+        } else if (!outfile.empty()) {
+            // on this job's thread, the pool's others are running jobs
+            std::ofstream out(outfile, std::ios::binary);
+            raster::render_tiled(v, out, to_double("scale", j.get("scale", "1")), 1);
+            out.close();
+            if (!out) {
+                throw std::runtime_error("could not write '" + outfile + "'");
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+
+        std::ostringstream out;
+        out << "{\"line\":" << j.line
+            << ",\"outfile\":" << to_json(outfile)
+            << ",\"steps\":" << v.steps()
+            << ",\"converged\":" << (v.converged() ? "true" : "false")
+            << ",\"nodes\":" << v.nodes().size()
+            << ",\"seconds\":" << seconds
+            << "}\n";
+        return out.str();
+    }
+
+    /**
+     * An estimate of the job's cost, so the largest can be started first
+     * and the last ones to finish are short.
+     */
+    unsigned long cost(const job& j) {
+        return to_unsigned("num-attractors", j.get("num-attractors", "1000"));
+    }
+
+}
+
+int main(int argc, const char* argv[]) {
+    settings s;
+    std::string jobs_file;
+    unsigned int threads = 0;
+
+    try {
+        po::options_description desc("Options");
+        desc.add_options()
+            ("help,h", "produce help message")
+            ("jobs", po::value<std::string>(),
+                "The job file, one simulation per line as space separated "
+                "key=value pairs. The keys are mode, index, placement, "
+                "num-attractors, seed, seeds, width, height, mask, "
+                "mask-shades, growth-radius, growth-rate, consume-radius, "
+                "no-growth-limit, max-steps, outfile and scale, each as the "
+                "venation option of the same name. An outfile ending in .svg "
+                "or .edges is exported from the tree, anything else is "
+                "written as a pnm image. Reads standard input if '-'.")
+            ("threads", po::value<unsigned int>(),
+                "The number of simulations run at once, each on its own "
+                "thread. Defaults to 0, which uses every available core.")
+            ("index", po::value<std::string>(),
+                "The spatial index of jobs that don't give one, 'delaunay' "
+                "or 'grid'. Defaults to 'grid'.")
+            ("max-steps", po::value<unsigned long>(),
+                "The step limit of jobs that don't give one. Defaults to 0, "
+                "which runs them until they converge.");
+
+        po::positional_options_description positional;
+        positional.add("jobs", 1);
+
+        po::variables_map vm;
+        po::store(po::command_line_parser(argc, argv)
+            .options(desc).positional(positional).run(), vm);
+        po::notify(vm);
+
+        if (vm.count("help") || !vm.count("jobs")) {
+            std::cout << "Venation batch runner\n\n"
+                << "Usage: venation_batch [options] jobs\n\n";
+            std::cout << desc << '\n';
+            return EXIT_FAILURE;
+        }
+
+        jobs_file = vm["jobs"].as<std::string>();
+
+        if (vm.count("threads")) {
+            threads = vm["threads"].as<unsigned int>();
+        }
+
+        if (vm.count("index")) {
+            s.index = vm["index"].as<std::string>();
+        }
+
+        if (vm.count("max-steps")) {
+            s.max_steps = vm["max-steps"].as<unsigned long>();
+        }
+    } catch (const po::error& ex) {
+        std::cerr << ex.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    std::vector<job> jobs;
+    std::map<std::string, mask_ptr> masks;
+
+    try {
+        if (jobs_file == "-") {
+            jobs = read_jobs(std::cin);
+        } else {
+            std::ifstream in(jobs_file);
+            if (!in) {
+                std::cerr << "Error: could not read the jobs in '" << jobs_file << "'\n";
+                return EXIT_FAILURE;
+            }
+            jobs = read_jobs(in);
+        }
+
+        // read each mask once, the jobs only ever read it
+        for (const auto& j : jobs) {
+            auto path = j.get("mask");
+            if (!path.empty() && masks.count(path) == 0) {
+                auto img = std::make_shared<boost::gil::rgb8_image_t>();
+                boost::gil::read_and_convert_image(path, *img, boost::gil::pnm_tag());
+                masks[path] = img;
+            }
+        }
+
+        // check every job before running any
+        for (const auto& j : jobs) {
+            try {
+                venation v;
+                configure(v, j, s, masks);
+                cost(j);
+                if (j.options.count("max-steps")) {
+                    to_unsigned("max-steps", j.get("max-steps"));
+                }
+                if (to_double("scale", j.get("scale", "1")) <= 0.0) {
+                    throw std::invalid_argument("expected a scale greater than 0");
+                }
+            } catch (const std::invalid_argument& ex) {
+                throw std::invalid_argument("line " + std::to_string(j.line) + ": " + ex.what());
+            }
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << "Error: " << ex.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    // largest first, keeping the file's order among equals
+    std::stable_sort(jobs.begin(), jobs.end(), [](const job& a, const job& b) {
+        return cost(a) > cost(b);
+    });
+
+    // Each simulation is single threaded, the pool's threads instead
+    // claim whole jobs, so an idle thread always takes the next one.
+    thread_pool pool(threads);
+    std::mutex output;
+    bool failed = false;
+
+    pool.parallel_for(jobs.size(), [&](std::size_t i) {
+        const auto& j = jobs[i];
+        try {
+            auto result = run(j, s, masks);
+            std::lock_guard<std::mutex> lock(output);
+            std::cout << result << std::flush;
+        } catch (const std::exception& ex) {
+            std::lock_guard<std::mutex> lock(output);
+            std::cerr << "Error: line " << j.line << ": " << ex.what() << '\n';
+            failed = true;
+        }
+    });
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+/**
+ * Microbenchmarks comparing the batched distance kernels in simd.hpp
+ * with the same computations done one pair at a time through util.hpp.
+ * Prints the nanoseconds per point for each and the speedup.
+ */
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include "growth/kernel.hpp"
+#include "growth/rng.hpp"
+#include "growth/simd.hpp"
+#include "util.hpp"
+
+using namespace growth;
+
+namespace {
+
+    // points per batch, about the number of nodes created in a step
+    constexpr std::size_t batch_size = 4096;
+    constexpr int repetitions = 2000;
+
+    /**
+     * Returns the nanoseconds per point taken by fn, which processes one
+     * batch of points.
+     */
+    template <typename F>
+    double time_per_point(F fn) {
+        fn();
+
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; ++r) {
+            fn();
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        return std::chrono::duration<double, std::nano>(end - start).count()
+            / (repetitions * (double)batch_size);
+    }
+
+    void report(const char* name, double helpers, double batched) {
+        std::cout << std::left << std::setw(26) << name << std::right
+            << std::fixed << std::setprecision(3)
+            << std::setw(10) << helpers << " ns"
+            << std::setw(10) << batched << " ns"
+            << std::setw(9) << std::setprecision(2) << helpers / batched << "x"
+            << std::endl;
+    }
+
+    /**
+     * Benchmarks the kernels with scalar type T against the util.hpp
+     * helpers on the matching kernel's points.
+     */
+    template <typename Kernel>
+    void run(const char* label) {
+        using T = typename Kernel::FT;
+        using point2 = typename Kernel::Point_2;
+
+        std::vector<T> xs(batch_size), ys(batch_size), bx(batch_size), by(batch_size);
+        std::vector<T> out(batch_size), dx(batch_size), dy(batch_size);
+        std::vector<std::uint8_t> live(batch_size, 1);
+        std::vector<point2> points, others;
+
+        for (std::size_t i = 0; i < batch_size; ++i) {
+            xs[i] = rng::uniform(0, rng::attractors, 4 * i) * 2.0 - 1.0;
+            ys[i] = rng::uniform(0, rng::attractors, 4 * i + 1) * 2.0 - 1.0;
+            bx[i] = rng::uniform(0, rng::attractors, 4 * i + 2) * 2.0 - 1.0;
+            by[i] = rng::uniform(0, rng::attractors, 4 * i + 3) * 2.0 - 1.0;
+            live[i] = i % 16 != 0;
+            points.push_back(point2(xs[i], ys[i]));
+            others.push_back(point2(bx[i], by[i]));
+        }
+
+        point2 p(0.1, -0.2);
+        T min_weight = 0.002;
+        volatile T sink = 0;
+
+        std::cout << label << " (" << simd::isa() << ")" << std::endl;
+
+        report("distances",
+            time_per_point([&]() {
+                for (std::size_t i = 0; i < batch_size; ++i) {
+                    out[i] = util::distance(points[i], p);
+                }
+                sink = sink + out[0];
+            }),
+            time_per_point([&]() {
+                simd::squared_distances(xs.data(), ys.data(), batch_size,
+                    (T)p.x(), (T)p.y(), out.data());
+                sink = sink + out[0];
+            }));
+
+        report("nearest",
+            time_per_point([&]() {
+                std::size_t best = batch_size;
+                T best_distance = std::numeric_limits<T>::infinity();
+                for (std::size_t i = 0; i < batch_size; ++i) {
+                    if (!live[i]) {
+                        continue;
+                    }
+
+                    T d = util::distance(points[i], p);
+                    if (d < best_distance) {
+                        best_distance = d;
+                        best = i;
+                    }
+                }
+                sink = sink + best;
+            }),
+            time_per_point([&]() {
+                T distance2;
+                sink = sink + simd::nearest(xs.data(), ys.data(), live.data(),
+                    batch_size, (T)p.x(), (T)p.y(), distance2);
+            }));
+
+        report("weighted directions",
+            time_per_point([&]() {
+                for (std::size_t i = 0; i < batch_size; ++i) {
+                    T distance = util::distance(points[i], others[i]);
+                    auto d = util::normalize(points[i] - others[i])
+                        / std::max(min_weight, distance);
+                    dx[i] = d.x();
+                    dy[i] = d.y();
+                }
+                sink = sink + dx[0];
+            }),
+            time_per_point([&]() {
+                simd::directions(xs.data(), ys.data(), bx.data(), by.data(),
+                    batch_size, min_weight, dx.data(), dy.data());
+                sink = sink + dx[0];
+            }));
+
+        std::cout << std::endl;
+    }
+
+}
+
+int main() {
+    std::cout << std::left << std::setw(26) << "kernel" << std::right
+        << std::setw(13) << "util.hpp" << std::setw(13) << "batched"
+        << std::setw(10) << "speedup" << std::endl << std::endl;
+
+    run<cgal_kernel>("cgal kernel, double");
+    run<float_kernel>("float kernel, float");
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+/**
+ * Stress test for thread_pool: runs many small parallel_for calls back to
+ * back on more threads than there are cores, so workers are often woken
+ * late, after the caller has moved on. Checks every index of every call
+ * ran exactly once with its own task, and prints the time per call.
+ * Exits with a failure status on the first mismatch.
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "growth/thread_pool.hpp"
+
+using namespace growth;
+
+int main(int argc, const char* argv[]) {
+    unsigned int threads = 4 * std::max(1u, std::thread::hardware_concurrency());
+    int calls = argc > 1 ? std::atoi(argv[1]) : 100000;
+
+    thread_pool pool(threads);
+    std::vector<std::atomic<int>> hits(64);
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int call = 0; call < calls; ++call) {
+        // sizes from 2 to 64, often fewer indices than threads
+        std::size_t n = 2 + call % 63;
+
+        pool.parallel_for(n, [&hits, call](std::size_t i) {
+            hits[i] += call + 1;
+        });
+
+        for (std::size_t i = 0; i < hits.size(); ++i) {
+            int expected = i < n ? call + 1 : 0;
+            if (hits[i] != expected) {
+                std::cerr << "call " << call << ": index " << i << " got "
+                    << hits[i] << ", expected " << expected << '\n';
+                return EXIT_FAILURE;
+            }
+        }
+
+        for (auto& h : hits) {
+            h = 0;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    std::cout << calls << " calls on " << pool.size() << " threads, "
+        << seconds * 1e6 / calls << " us per call\n";
+
+    return EXIT_SUCCESS;
+}
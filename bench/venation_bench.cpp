@@ -0,0 +1,318 @@
+/**
+ * Runs the simulation over a fixed set of workloads, open and closed
+ * venation with 1k to 1M attractors, with and without each of the shipped
+ * masks, and prints one JSON object per workload on its own line. Every
+ * workload is seeded the same way, so the work done only changes with
+ * the code, and runs in its own process so its peak memory is its own.
+ *
+ * Workloads too large for a machine can be left out with the options,
+ * see --help.
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <initializer_list>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <boost/gil/image.hpp>
+#include <boost/gil/typedefs.hpp>
+#include <boost/gil/extension/io/pnm.hpp>
+#include <boost/program_options.hpp>
+
+#include "growth/venation.hpp"
+
+namespace po = boost::program_options;
+
+using namespace growth;
+
+#ifndef GROWTH_MASKS_DIR
+#define GROWTH_MASKS_DIR "masks"
+#endif
+
+namespace {
+
+    struct workload {
+        std::string mode;
+        unsigned int num_attractors;
+        // the mask's path, empty for none
+        std::string mask;
+    };
+
+    struct settings {
+        std::string index = "grid";
+        unsigned int threads = 0;
+        unsigned long max_steps = 10000;
+        std::uint64_t seed = 1;
+    };
+
+    /**
+     * Returns the value if it is one of the choices.
+     */
+    std::string to_choice(const std::string& key, const std::string& value,
+            std::initializer_list<const char*> choices) {
+        std::string expected;
+        for (auto choice : choices) {
+            if (value == choice) {
+                return value;
+            }
+            expected += (expected.empty() ? "'" : " or '") + std::string(choice) + "'";
+        }
+
+        throw std::invalid_argument("expected " + expected + " for " + key
+            + ", got '" + value + "'");
+    }
+
+    double seconds_since(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * Runs the workload to convergence, or to the step limit, and writes
+     * its results as a JSON object on one line.
+     */
+    void run(const workload& w, const settings& s) {
+        venation v;
+
+        if (w.mask.empty()) {
+            v.configure(512, 512);
+        } else {
+            boost::gil::rgb8_image_t mask_img;
+            boost::gil::read_and_convert_image(w.mask, mask_img, boost::gil::pnm_tag());
+            v.mask(mask_img);
+        }
+
+        v.mode(w.mode)
+            .index(s.index)
+            .threads(s.threads)
+            .num_attractors(w.num_attractors)
+            .random_seed(s.seed);
+
+        auto start = std::chrono::steady_clock::now();
+        v.setup();
+        double setup_time = seconds_since(start);
+        std::size_t num_attractors = v.attractors().count();
+
+        start = std::chrono::steady_clock::now();
+        while (!v.converged() && v.steps() < s.max_steps) {
+            v.update();
+        }
+        double run_time = seconds_since(start);
+
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        // kilobytes on Linux, bytes on macOS
+#ifdef __APPLE__
+        long peak_rss_kb = usage.ru_maxrss / 1024;
+#else
+        long peak_rss_kb = usage.ru_maxrss;
+#endif
+
+        const auto& phases = v.timings();
+        auto steps = v.steps();
+        std::string mask = w.mask.empty()
+            ? "none" : std::filesystem::path(w.mask).filename().string();
+
+        std::ostringstream out;
+        out << "{\"mode\":\"" << w.mode << "\""
+            << ",\"index\":\"" << s.index << "\""
+            << ",\"requested_attractors\":" << w.num_attractors
+            << ",\"attractors\":" << num_attractors
+            << ",\"mask\":\"" << mask << "\""
+            << ",\"seed\":" << s.seed
+            << ",\"threads\":" << s.threads
+            << ",\"steps\":" << steps
+            << ",\"converged\":" << (v.converged() ? "true" : "false")
+            << ",\"setup_s\":" << setup_time
+            << ",\"run_s\":" << run_time
+            << ",\"steps_per_s\":" << (run_time > 0.0 ? steps / run_time : 0.0)
+            << ",\"ms_per_step\":" << (steps > 0 ? run_time * 1000.0 / steps : 0.0)
+            << ",\"phases_s\":{"
+                << "\"associate\":" << phases.associate
+                << ",\"grow\":" << phases.grow
+                << ",\"consume\":" << phases.consume
+                << ",\"prune\":" << phases.prune
+                << ",\"maintain\":" << phases.maintain << "}"
+            << ",\"nodes\":" << v.nodes().size()
+            << ",\"attractors_left\":" << v.attractors().count()
+            << ",\"peak_rss_kb\":" << peak_rss_kb
+            << "}\n";
+        std::cout << out.str() << std::flush;
+    }
+
+    /**
+     * Runs the workload in a child process. Returns false if it failed.
+     */
+    bool run_isolated(const workload& w, const settings& s) {
+        std::cout << std::flush;
+        pid_t pid = fork();
+
+        if (pid < 0) {
+            std::cerr << "Error: could not start a process for the workload\n";
+            return false;
+        }
+
+        if (pid == 0) {
+            int status = EXIT_SUCCESS;
+            try {
+                run(w, s);
+            } catch (const std::exception& ex) {
+                std::cerr << "Error: " << ex.what() << '\n';
+                status = EXIT_FAILURE;
+            }
+            _exit(status);
+        }
+
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS) {
+            return true;
+        }
+
+        std::cerr << "Error: the " << w.mode << " workload with "
+            << w.num_attractors << " attractors and mask '"
+            << (w.mask.empty() ? "none" : w.mask) << "' failed\n";
+        return false;
+    }
+
+}
+
+int main(int argc, const char* argv[]) {
+    settings s;
+    std::vector<std::string> modes;
+    unsigned int min_attractors = 1000;
+    unsigned int max_attractors = 1000000;
+    std::string masks_dir = GROWTH_MASKS_DIR;
+    bool with_masks = true;
+
+    try {
+        po::options_description desc("Options");
+        desc.add_options()
+            ("help,h", "produce help message")
+            ("mode", po::value<std::string>(),
+                "Only run 'open' or 'closed' venation. Defaults to both.")
+            ("index", po::value<std::string>(),
+                "Spatial index, 'delaunay' or 'grid'. Defaults to 'grid'.")
+            ("min-attractors", po::value<unsigned int>(),
+                "Skip the workloads with fewer attractors. Defaults to 1000.")
+            ("max-attractors", po::value<unsigned int>(),
+                "Skip the workloads with more attractors. Defaults to 1000000.")
+            ("max-steps", po::value<unsigned long>(),
+                "The step limit for workloads that have not converged. "
+                "Defaults to 10000.")
+            ("threads", po::value<unsigned int>(),
+                "The number of threads, 0 uses every available core. "
+                "Defaults to 0.")
+            ("seed", po::value<std::uint64_t>(),
+                "The seed for the random number generator. Defaults to 1.")
+            ("masks", po::value<std::string>(),
+                "The directory holding the pnm masks. Defaults to the "
+                "source tree's masks directory.")
+            ("no-masks", "Only run the workloads without a mask.");
+
+        po::variables_map vm;
+        po::store(po::parse_command_line(argc, argv, desc), vm);
+        po::notify(vm);
+
+        if (vm.count("help")) {
+            std::cout << "Venation benchmark\n\n"
+                << "Prints one JSON object per workload on its own line.\n\n";
+            std::cout << desc << '\n';
+            return EXIT_FAILURE;
+        }
+
+        if (vm.count("mode")) {
+            modes.push_back(to_choice("mode", vm["mode"].as<std::string>(),
+                { "open", "closed" }));
+        } else {
+            modes = { "open", "closed" };
+        }
+
+        if (vm.count("index")) {
+            s.index = to_choice("index", vm["index"].as<std::string>(),
+                { "delaunay", "grid" });
+        }
+
+        if (vm.count("min-attractors")) {
+            min_attractors = vm["min-attractors"].as<unsigned int>();
+        }
+
+        if (vm.count("max-attractors")) {
+            max_attractors = vm["max-attractors"].as<unsigned int>();
+        }
+
+        if (vm.count("max-steps")) {
+            s.max_steps = vm["max-steps"].as<unsigned long>();
+        }
+
+        if (vm.count("threads")) {
+            s.threads = vm["threads"].as<unsigned int>();
+        }
+
+        if (vm.count("seed")) {
+            s.seed = vm["seed"].as<std::uint64_t>();
+        }
+
+        if (vm.count("masks")) {
+            masks_dir = vm["masks"].as<std::string>();
+        }
+
+        if (vm.count("no-masks")) {
+            with_masks = false;
+        }
+    } catch (const po::error& ex) {
+        std::cerr << ex.what() << '\n';
+        return EXIT_FAILURE;
+    } catch (const std::invalid_argument& ex) {
+        std::cerr << "Error: " << ex.what() << '\n';
+        return EXIT_FAILURE;
+    }
+
+    // no mask first, then the shipped masks in name order
+    std::vector<std::string> masks = { "" };
+    if (with_masks) {
+        std::vector<std::string> found;
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(masks_dir, error)) {
+            if (entry.path().extension() == ".pnm") {
+                found.push_back(entry.path().string());
+            }
+        }
+
+        if (error) {
+            std::cerr << "Error: could not read the masks in '" << masks_dir << "'\n";
+            return EXIT_FAILURE;
+        }
+
+        std::sort(found.begin(), found.end());
+        masks.insert(masks.end(), found.begin(), found.end());
+    }
+
+    bool failed = false;
+
+    for (const auto& mode : modes) {
+        for (unsigned int n : { 1000u, 10000u, 100000u, 1000000u }) {
+            if (n < min_attractors || n > max_attractors) {
+                continue;
+            }
+
+            for (const auto& mask : masks) {
+                if (!run_isolated({ mode, n, mask }, s)) {
+                    failed = true;
+                }
+            }
+        }
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
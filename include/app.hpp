@@ -1,7 +1,9 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <boost/gil/image.hpp>
@@ -12,6 +14,9 @@
 
 #include <GLFW/glfw3.h>
 
+#include "growth/checkpoint.hpp"
+#include "growth/snapshot.hpp"
+#include "growth/triple_buffer.hpp"
 #include "growth/venation.hpp"
 
 using namespace growth;
@@ -19,6 +24,10 @@ using namespace growth;
 /*
  * This class manages the execution of the venation simulation
  * and other openGL, input, and output related things.
+ *
+ * With a window the simulation runs on its own thread between start()
+ * and stop(), handing snapshots of its state to draw() through a triple
+ * buffer, so it steps as fast as the CPU allows whatever the frame rate.
  */
 class App {
     public:
@@ -45,15 +54,33 @@ class App {
         /**
          * Updates the simulation, equivalent to a single timestep, though a
          * true time step is not present here. Instead, the speed is dependant
-         * on the framerate, which varies depending on the available resources.
+         * on the available resources.
          */
         void update();
 
         /**
-         * Draws the state of the simulation
+         * Starts stepping the simulation on its own thread until it is
+         * done or stopped.
+         */
+        void start();
+
+        /**
+         * Stops the simulation thread and waits for it, publishing the
+         * final state for the next draw().
+         */
+        void stop();
+
+        /**
+         * Draws the latest snapshot of the simulation.
          */
         void draw();
 
+        /**
+         * Writes the result to the output file, if one was given, once the
+         * simulation is done, and a last checkpoint if they are enabled.
+         */
+        void finish();
+
         // modifiers
         void toggle_attractors() { show_attractors_ = !show_attractors_; }
         void play_pause() { running_ = !running_; }
@@ -65,17 +92,53 @@ class App {
         // getters
         unsigned int width() { return venation_.width(); }
         unsigned int height() { return venation_.height(); }
+        bool headless() { return headless_; }
+        bool done() { return done_; }
 
     private:
 
+        void simulate();
+        void publish();
         void check_timeout();
+        void check_steps();
+        void save();
+        void check_checkpoint();
+        void write_checkpoint();
 
         venation venation_;
+        std::thread simulation_;
+        triple_buffer<snapshot> snapshots_;
         unsigned int timeout_ = 60;
-        bool show_attractors_ = false;
-        bool running_ = true;
+        unsigned long max_steps_ = 0;
+        bool until_converged_ = false;
+        bool defer_pruning_ = false;
+        // shared between the simulation and drawing threads
+        std::atomic<bool> show_attractors_{false};
+        std::atomic<bool> running_{true};
+        std::atomic<bool> done_{false};
+        std::atomic<bool> stopping_{false};
+        bool headless_ = false;
         std::string out_file_;
+        // the outfile's lowercase extension, which picks how it is written
+        std::string out_format_;
+        // the pnm outfile's size relative to the simulation's
+        double scale_ = 1.0;
+        unsigned int threads_ = 0;
+        std::string trace_file_;
+        std::string checkpoint_file_;
+        unsigned int checkpoint_interval_ = 300;
+        bool resume_ = false;
+        // filled on the simulation thread, then written on its own
+        // thread while the simulation carries on
+        checkpoint checkpoint_;
+        std::thread checkpoint_writer_;
+        std::atomic<bool> checkpoint_written_{false};
+        std::chrono::time_point<std::chrono::system_clock> last_checkpoint_;
         std::chrono::time_point<std::chrono::system_clock> start_;
-        GLFWwindow* window_;
+        std::chrono::duration<double> step_time_{0};
+        GLFWwindow* window_ = nullptr;
+        // the size scaled to fit by scale_to_fit(), 0 if it wasn't
+        int fit_width_ = 0;
+        int fit_height_ = 0;
 
 };
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace growth {
+
+    /**
+     * Walker's alias method for drawing indices in proportion to a fixed
+     * set of weights in constant time. Each index keeps the probability of
+     * being picked itself once landed on, and the index it otherwise
+     * defers to. Built with Vose's linear time construction.
+     */
+    class alias_table {
+        public:
+
+            // an empty table
+            alias_table() = default;
+            ~alias_table() = default;
+
+            /**
+             * Builds the table over the weights, which must not be negative.
+             * The table is empty if none of them is positive.
+             */
+            explicit alias_table(const std::vector<float>& weights);
+
+            /**
+             * Picks an index from two uniform random numbers in [0, 1),
+             * each index with probability proportional to its weight.
+             * The table must not be empty.
+             */
+            std::size_t sample(double u, double v) const {
+                std::size_t i = std::min(probability_.size() - 1,
+                    (std::size_t)(u * probability_.size()));
+                return v < probability_[i] ? i : alias_[i];
+            }
+
+            // getters
+            std::size_t size() const { return probability_.size(); }
+            bool empty() const { return probability_.empty(); }
+
+        private:
+
+            std::vector<float> probability_;
+            std::vector<std::uint32_t> alias_;
+
+    };
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "kernel.hpp"
+
+namespace growth {
+
+    /**
+     * A stream of attractors added while the simulation runs, as in
+     * marginal growth where new attractors appear in the leaf blade as it
+     * expands. The simulation pulls a batch of candidates at the start of
+     * every step, and drops those too close to a node or attractor before
+     * inserting the rest.
+     */
+    template <typename Kernel>
+    class attractor_source {
+        public:
+
+            // types from the kernel for representing the points
+            using kernel = Kernel;
+            using point2 = typename kernel::Point_2;
+
+            virtual ~attractor_source() = default;
+
+            /**
+             * Appends the candidates for the step, numbered from 1, to
+             * points. Their coordinates are in [-1, 1] and are scaled to
+             * the simulation's aspect ratio like the seeds. Returns false
+             * once no more candidates will come.
+             */
+            virtual bool next(unsigned long step, std::vector<point2>& points) = 0;
+
+    };
+
+    /**
+     * A square leaf blade growing about the center, scaled linearly from
+     * nothing to its full size over a number of steps. Each of those steps
+     * scatters a fixed number of candidates over the blade at random, the
+     * ones landing near existing attractors being rejected, so the blade
+     * fills in with attractors as it grows.
+     */
+    template <typename Kernel>
+    class expanding_source: public attractor_source<Kernel> {
+        public:
+
+            using point2 = typename Kernel::Point_2;
+
+            expanding_source(unsigned long steps, unsigned int per_step,
+                std::uint64_t seed = 0):
+                steps_(steps), per_step_(per_step), seed_(seed) {}
+            ~expanding_source() = default;
+
+            bool next(unsigned long step, std::vector<point2>& points) override;
+
+        private:
+
+            unsigned long steps_;
+            unsigned int per_step_;
+            std::uint64_t seed_;
+
+    };
+
+}
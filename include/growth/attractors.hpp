@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "kernel.hpp"
+#include "node.hpp"
+
+namespace growth {
+
+    /**
+     * Flat storage for the attractors. Each property is kept in its own
+     * contiguous column, and removed attractors are only marked dead until
+     * enough of them have accumulated to be worth compacting away in one
+     * pass. Compaction keeps the live attractors in order, so iteration
+     * order never depends on the order of removals.
+     *
+     * Each attractor also caches its closest growth node, so only nodes
+     * created since it was last computed need to be compared against.
+     * nearest_seen is the number of nodes that existed when the cache was
+     * last brought up to date, 0 if never.
+     *
+     * Attractors out of reach of every node can be put to sleep. Dormant
+     * attractors are left out of the active list the simulation steps
+     * through, and are bucketed into a coarse grid so the ones near a new
+     * node can be found and woken. The grid also counts the live attractors
+     * in each cell, so the regions left without any can be skipped.
+     */
+    template <typename Kernel>
+    class basic_attractor_set {
+        public:
+
+            // types from the kernel for representing the points
+            using kernel = Kernel;
+            using scalar = typename kernel::FT;
+            using point2 = typename kernel::Point_2;
+
+            // trivial constructor and destructor
+            basic_attractor_set(double max_dead_fraction = 0.25)
+                : max_dead_fraction_(max_dead_fraction) {}
+            ~basic_attractor_set() = default;
+
+            /**
+             * Appends a batch of attractors, which start out active.
+             */
+            void insert(const std::vector<point2>& points);
+
+            /**
+             * Marks the attractor at index i as dead.
+             */
+            void remove(std::size_t i);
+
+            /**
+             * Removes the dead attractors if they make up more than the
+             * maximum dead fraction of the storage. Indices are only stable
+             * between calls. Returns whether the storage was compacted.
+             */
+            bool compact();
+
+            /**
+             * Removes every attractor.
+             */
+            void clear();
+
+            /**
+             * Sets up the grid dormant attractors are bucketed in, waking
+             * any that are dormant. Until it is called none can sleep.
+             */
+            void partition(scalar min_x, scalar min_y, scalar max_x, scalar max_y,
+                scalar cell_size);
+
+            /**
+             * Flags the active attractor at index i to be put to sleep by
+             * the next settle(). Safe to call for different attractors from
+             * several threads.
+             */
+            void sleep(std::size_t i) {
+                if (columns_ > 0) {
+                    dormant[i] = 1;
+                }
+            }
+
+            /**
+             * Wakes the dormant attractors closer than radius to (x, y),
+             * resetting their nearest cache as it has not been kept up to
+             * date. They rejoin the active list on the next settle().
+             */
+            void wake(scalar x, scalar y, scalar radius);
+
+            /**
+             * Wakes every dormant attractor.
+             */
+            void wake_all();
+
+            /**
+             * Brings the active list up to date, dropping the dead
+             * attractors and bucketing the ones flagged to sleep, then
+             * merging in the woken ones.
+             */
+            void settle();
+
+            /**
+             * Whether a live attractor, dormant or not, may be closer than
+             * radius to (x, y). Only the cells' counts are looked at, so it
+             * can be true when none is. Always true until partition().
+             */
+            bool any_within(scalar x, scalar y, scalar radius) const;
+
+            // getters
+            std::size_t size() const { return x.size(); }
+            std::size_t count() const { return x.size() - dead_; }
+            bool empty() const { return count() == 0; }
+            bool alive(std::size_t i) const { return live[i] != 0; }
+            point2 position(std::size_t i) const { return point2(x[i], y[i]); }
+            // indices of the attractors not asleep, in order
+            const std::vector<std::size_t>& active() const { return active_; }
+            std::size_t num_dormant() const { return num_dormant_; }
+
+            // columns
+            std::vector<scalar> x;
+            std::vector<scalar> y;
+            std::vector<std::uint8_t> live;
+            std::vector<std::uint8_t> dormant;
+            std::vector<node_id> nearest_node;
+            std::vector<scalar> nearest_distance;
+            std::vector<unsigned int> nearest_seen;
+
+        private:
+
+            std::size_t cell(std::size_t i) const;
+            void bucket(std::size_t i);
+            void wake_one(std::size_t i);
+            int column(scalar x) const;
+            int row(scalar y) const;
+
+            std::size_t dead_ = 0;
+            double max_dead_fraction_;
+
+            std::vector<std::size_t> active_;
+            std::vector<std::size_t> woken_;
+
+            // dormant attractors by grid cell
+            std::vector<std::vector<std::size_t>> cells_;
+            // live attractors by grid cell, dormant or not
+            std::vector<unsigned int> counts_;
+            std::size_t num_dormant_ = 0;
+            int columns_ = 0;
+            int rows_ = 0;
+            scalar min_x_ = 0;
+            scalar min_y_ = 0;
+            scalar cell_size_ = 1;
+
+    };
+
+    using attractor_set = basic_attractor_set<default_kernel>;
+
+}
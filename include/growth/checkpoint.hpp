@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "kernel.hpp"
+#include "node.hpp"
+
+namespace growth {
+
+    /**
+     * A copy of a simulation's state, enough to resume it exactly where it
+     * was, and its binary file format.
+     *
+     * The file starts with a fixed header and a table of sections, each an
+     * array of fixed size elements stored as they are in memory, aligned to
+     * 64 bytes. A reader can map the file and copy or use the arrays in
+     * place without parsing anything. The version is bumped whenever the
+     * layout changes, and files written with a different scalar size or
+     * byte order are refused.
+     *
+     * There is no random generator state to save, every random number is a
+     * function of the seed and what it is drawn for, see rng.hpp.
+     */
+    template <typename Kernel>
+    class basic_checkpoint {
+        public:
+
+            using scalar = typename Kernel::FT;
+
+            static constexpr std::uint32_t version = 1;
+
+            // the simulation's parameters and progress, stored as one section
+            struct parameters {
+                std::uint64_t steps = 0;
+                std::uint64_t seed = 0;
+                std::uint32_t mode = 0;
+                std::uint32_t index = 0;
+                std::uint32_t placement = 0;
+                std::uint32_t width = 0;
+                std::uint32_t height = 0;
+                std::uint32_t num_attractors = 0;
+                std::uint32_t mask_shades = 0;
+                std::uint32_t mask_given = 0;
+                std::uint32_t mask_width = 0;
+                std::uint32_t mask_height = 0;
+                std::uint32_t no_growth_limit = 0;
+                std::int32_t no_growth_count = 0;
+                std::uint32_t defer_pruning = 0;
+                std::uint32_t source_active = 0;
+                double aspect_ratio = 1.0;
+                double growth_radius = 0.0;
+                double growth_rate = 0.0;
+                double consume_radius = 0.0;
+                double birth_radius = 0.0;
+                double sleep_radius = 0.0;
+                double retire_radius = 0.0;
+            };
+
+            /**
+             * Writes the checkpoint to the file at path, replacing it only
+             * once the whole checkpoint has been written. Throws a
+             * std::runtime_error if it can't be written.
+             */
+            void write(const std::string& path) const;
+
+            /**
+             * Reads the checkpoint from the file at path. Throws a
+             * std::runtime_error if it can't be read or isn't a checkpoint
+             * of this version for this scalar type.
+             */
+            void read(const std::string& path);
+
+            /**
+             * Returns what is wrong with the checkpoint's contents, or an
+             * empty string if it can be loaded: every id in range, the
+             * columns of the nodes and of the attractors of equal
+             * lengths, the tree's links consistent, and the front and
+             * archive holding only live nodes. read() refuses a file that
+             * fails it.
+             */
+            std::string validate() const;
+
+            parameters params;
+
+            // the node arena's columns
+            std::vector<scalar> node_x;
+            std::vector<scalar> node_y;
+            std::vector<scalar> node_dx;
+            std::vector<scalar> node_dy;
+            std::vector<scalar> node_width;
+            std::vector<node_id> node_parent;
+            std::vector<node_id> node_first_child;
+            std::vector<node_id> node_next_sibling;
+            std::vector<std::uint8_t> node_live;
+
+            // the live attractors' columns
+            std::vector<scalar> attractor_x;
+            std::vector<scalar> attractor_y;
+            std::vector<std::uint8_t> attractor_dormant;
+            std::vector<node_id> attractor_nearest_node;
+            std::vector<scalar> attractor_nearest_distance;
+            std::vector<unsigned int> attractor_nearest_seen;
+
+            // the seeds as x, y pairs, and the pruning candidates as
+            // node pairs
+            std::vector<scalar> seeds;
+            std::vector<node_id> prune_candidates;
+            std::vector<node_id> front;
+            std::vector<node_id> archive;
+            std::vector<float> mask_data;
+
+    };
+
+    using checkpoint = basic_checkpoint<default_kernel>;
+
+}
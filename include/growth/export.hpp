@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+
+#include "venation.hpp"
+
+namespace growth {
+
+    /**
+     * Writers for the grown tree that keep every node's position and
+     * width, unlike an image. They walk the tree from the seeds and
+     * write it out through a small buffer as they go, so memory use does
+     * not grow with the size of the tree, and write to a file descriptor
+     * so the output can go to a file or down a pipe alike. They throw a
+     * std::runtime_error if the descriptor can't be written to, and never
+     * close it.
+     */
+    namespace exporters {
+
+        /**
+         * The header of an edge list. It is followed by one edge per node
+         * until the end of the file, in the byte order of the machine that
+         * wrote it.
+         */
+        struct edge_header {
+            char magic[8];
+            std::uint32_t version;
+            // the size of an edge in bytes
+            std::uint32_t edge_size;
+            // the simulation's size in pixels and its aspect ratio
+            std::uint32_t width;
+            std::uint32_t height;
+            float aspect_ratio;
+            std::uint32_t reserved;
+        };
+
+        /**
+         * A node of the tree and the edge to its parent. Nodes are
+         * numbered by their order in the file, and each comes after its
+         * parent, so a reader can build the tree in one pass. Positions
+         * are in the simulation's coordinates, x in [-aspect ratio,
+         * aspect ratio] and y in [-1, 1], y pointing up.
+         */
+        struct edge {
+            float x;
+            float y;
+            float width;
+            // no_node for the seeds
+            std::uint32_t parent;
+        };
+
+        constexpr std::uint32_t edge_version = 1;
+
+        /**
+         * Writes the tree as an SVG document the simulation's size in
+         * pixels, each edge as a white line on black, as wide as the
+         * image output draws it.
+         */
+        template <typename Kernel>
+        void write_svg(int fd, basic_venation<Kernel>& v);
+
+        /**
+         * Writes the tree as a binary edge list, an edge_header then one
+         * edge per node.
+         */
+        template <typename Kernel>
+        void write_edges(int fd, basic_venation<Kernel>& v);
+
+    }
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+
+namespace growth {
+
+    /**
+     * A plain 2D vector of scalars, providing the subset of CGAL's
+     * Vector_2 interface that the simulation uses.
+     */
+    template <typename T>
+    class basic_vector2 {
+        public:
+
+            basic_vector2() = default;
+            basic_vector2(T x, T y): x_(x), y_(y) {}
+
+            T x() const { return x_; }
+            T y() const { return y_; }
+            T squared_length() const { return x_ * x_ + y_ * y_; }
+
+            friend basic_vector2 operator+(const basic_vector2& a, const basic_vector2& b) {
+                return basic_vector2(a.x_ + b.x_, a.y_ + b.y_);
+            }
+
+            friend basic_vector2 operator-(const basic_vector2& a, const basic_vector2& b) {
+                return basic_vector2(a.x_ - b.x_, a.y_ - b.y_);
+            }
+
+            friend basic_vector2 operator-(const basic_vector2& a) {
+                return basic_vector2(-a.x_, -a.y_);
+            }
+
+            friend basic_vector2 operator*(const basic_vector2& a, T s) {
+                return basic_vector2(a.x_ * s, a.y_ * s);
+            }
+
+            friend basic_vector2 operator/(const basic_vector2& a, T s) {
+                return basic_vector2(a.x_ / s, a.y_ / s);
+            }
+
+            friend bool operator==(const basic_vector2& a, const basic_vector2& b) {
+                return a.x_ == b.x_ && a.y_ == b.y_;
+            }
+
+            friend bool operator!=(const basic_vector2& a, const basic_vector2& b) {
+                return !(a == b);
+            }
+
+        private:
+
+            T x_ = 0;
+            T y_ = 0;
+
+    };
+
+    /**
+     * A plain 2D point of scalars, providing the subset of CGAL's
+     * Point_2 interface that the simulation uses.
+     */
+    template <typename T>
+    class basic_point2 {
+        public:
+
+            basic_point2() = default;
+            basic_point2(T x, T y): x_(x), y_(y) {}
+
+            T x() const { return x_; }
+            T y() const { return y_; }
+
+            friend basic_vector2<T> operator-(const basic_point2& a, const basic_point2& b) {
+                return basic_vector2<T>(a.x_ - b.x_, a.y_ - b.y_);
+            }
+
+            friend basic_point2 operator+(const basic_point2& a, const basic_vector2<T>& v) {
+                return basic_point2(a.x_ + v.x(), a.y_ + v.y());
+            }
+
+            friend bool operator==(const basic_point2& a, const basic_point2& b) {
+                return a.x_ == b.x_ && a.y_ == b.y_;
+            }
+
+            friend bool operator!=(const basic_point2& a, const basic_point2& b) {
+                return !(a == b);
+            }
+
+            friend T squared_distance(const basic_point2& a, const basic_point2& b) {
+                return (a - b).squared_length();
+            }
+
+        private:
+
+            T x_ = 0;
+            T y_ = 0;
+
+    };
+
+    /**
+     * A kernel of plain scalars, named like a CGAL kernel so either can
+     * be used to instantiate the simulation. Its predicates are only as
+     * exact as the scalar type.
+     */
+    template <typename T>
+    struct scalar_kernel {
+        using FT = T;
+        using Point_2 = basic_point2<T>;
+        using Vector_2 = basic_vector2<T>;
+    };
+
+    // the kernels the growth library is instantiated with
+    using float_kernel = scalar_kernel<float>;
+    using double_kernel = scalar_kernel<double>;
+    using cgal_kernel = CGAL::Exact_predicates_inexact_constructions_kernel;
+
+    // the kernel selected at build time with GROWTH_KERNEL
+#if defined(GROWTH_KERNEL_FLOAT)
+    using default_kernel = float_kernel;
+#elif defined(GROWTH_KERNEL_DOUBLE)
+    using default_kernel = double_kernel;
+#else
+    using default_kernel = cgal_kernel;
+#endif
+
+}
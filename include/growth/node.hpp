@@ -1,57 +1,107 @@
 #pragma once
 
-#include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <vector>
-#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+
+#include "kernel.hpp"
 
 namespace growth {
 
-    typedef std::shared_ptr<struct node> node_ref;
+    // nodes are referred to by their index in the arena
+    using node_id = unsigned int;
+    constexpr node_id no_node = std::numeric_limits<node_id>::max();
 
     /**
-     * Structure for representing a node that represents whatever
-     * is growing in the simulation. It can be considered as the veines
-     * or the tree that is being generated.
+     * Storage for the nodes that represent whatever is growing in the
+     * simulation. It can be considered as the veines or the tree that is
+     * being generated. Each property is kept in its own contiguous column
+     * indexed by node id, and the tree is linked through parent, first
+     * child and next sibling ids. Nodes are never moved, so ids stay valid
+     * for the lifetime of the arena.
      */
-    struct node {
-        // types from CGAL for representing the points with robust numerical predicates.
-        using kernel = CGAL::Exact_predicates_inexact_constructions_kernel;
-        using point2 = kernel::Point_2;
-        using vector2 = kernel::Vector_2;
-
-        // trivial constructor and destructor
-        node(const point2& p, const vector2& d, double base_width = 0.3)
-            : position(p), direction(d), base_width(base_width), 
-            width(base_width) {}
-
-        ~node() = default;
-
-        /**
-         * Optimizes the node tree by removing nodes with one parent.
-         * Returns a vector of nodes that have been deleted from the tree.
-         */
-        std::vector<node_ref> optimize();
-
-        /**
-         * Computes the width the structure should be at the node's point
-         * as the recursive sum of its childrens' widths.
-         * Returns the computed width.
-         */
-        double update_width();
-
-        /**
-         * Creates a node at the given point and direction.
-         * Returns a smart pointer that references it.
-         */
-        static node_ref create(const point2& p, const vector2& d);
-
-        // data members
-        std::vector<node_ref> children;
-        point2 position;
-        vector2 direction;
-        double width;
-        double base_width;
+    template <typename Kernel>
+    class basic_node_arena {
+        public:
+
+            // types from the kernel for representing the points
+            using kernel = Kernel;
+            using scalar = typename kernel::FT;
+            using point2 = typename kernel::Point_2;
+            using vector2 = typename kernel::Vector_2;
+
+            // trivial constructor and destructor
+            basic_node_arena(scalar base_width = 0.3): base_width_(base_width) {}
+            ~basic_node_arena() = default;
+
+            /**
+             * Creates a node at the given point and direction, appending it
+             * to the parent's children if one is given. The widths of the
+             * parent and its ancestors are updated to account for the new leaf.
+             * Returns the new node's id.
+             */
+            node_id create(const point2& p, const vector2& d, node_id parent = no_node);
+
+            /**
+             * Optimizes the tree below the given node by removing nodes with
+             * one child along straight lines from it.
+             * Returns the ids of the nodes that have been removed from the tree.
+             */
+            std::vector<node_id> optimize(node_id n);
+
+            /**
+             * Optimizes only the straight line from node n starting at its
+             * child, which is replaced by the last node of the line.
+             * The ids of the removed nodes are appended to removed.
+             */
+            void optimize(node_id n, node_id child, std::vector<node_id>& removed);
+
+            /**
+             * Recomputes the width the structure should be at the node's point
+             * from its childrens' widths, then walks up through its ancestors
+             * doing the same until a width is left unchanged.
+             */
+            void update_width(node_id n);
+
+            /**
+             * Removes every node.
+             */
+            void clear();
+
+            /**
+             * Rebuilds what is derived from the columns after they have
+             * been filled in directly, as when loading a checkpoint.
+             */
+            void relink();
+
+            // getters
+            std::size_t size() const { return x.size(); }
+            point2 position(node_id n) const { return point2(x[n], y[n]); }
+            vector2 direction(node_id n) const { return vector2(dx[n], dy[n]); }
+            bool has_children(node_id n) const { return first_child[n] != no_node; }
+            node_id last_child(node_id n) const { return last_child_[n]; }
+
+            // columns
+            std::vector<scalar> x;
+            std::vector<scalar> y;
+            std::vector<scalar> dx;
+            std::vector<scalar> dy;
+            std::vector<scalar> width;
+            std::vector<node_id> parent;
+            std::vector<node_id> first_child;
+            std::vector<node_id> next_sibling;
+            // 0 once a node has been optimized out of the tree
+            std::vector<std::uint8_t> live;
+
+        private:
+
+            // the last child of each node, so children can be appended in order
+            std::vector<node_id> last_child_;
+            scalar base_width_;
 
     };
 
+    using node_arena = basic_node_arena<default_kernel>;
+
 }
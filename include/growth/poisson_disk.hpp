@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+namespace growth {
+
+    /**
+     * Blue noise over a rectangle: random points no two of which are
+     * closer than a radius. The radius shrinks with the square root of an
+     * optional density, so each region gets points in proportion to it
+     * while staying evenly spaced.
+     *
+     * Points are placed by dart throwing over a grid of cells too small
+     * to hold two points. Every round throws one dart into each empty
+     * cell, kept if no point is within the radius. The grid is split into
+     * tiles at least the largest radius wide and colored in a 2 by 2
+     * pattern, so tiles of the same color can't interfere and are filled
+     * in parallel, one color after the other. Darts are counter based
+     * random numbers indexed by round and cell, so the points only depend
+     * on the seed.
+     */
+    class poisson_disk {
+        public:
+
+            // samples the rectangle with a uniform density
+            poisson_disk(double min_x, double min_y, double max_x, double max_y);
+            ~poisson_disk() = default;
+
+            /**
+             * Stretches an image of densities in [0, 1], its rows from the
+             * top, over the rectangle. Points are only placed where it is
+             * positive.
+             */
+            poisson_disk& density(const std::vector<float>& weights,
+                unsigned int width, unsigned int height);
+
+            // setters, more rounds fill the gaps left between points
+            poisson_disk& rounds(unsigned int n) { rounds_ = n; return *this; }
+
+            /**
+             * Places about count points, the radius chosen to fit them in
+             * the density with the default number of rounds. Returns them
+             * in the grid's row order.
+             */
+            std::vector<std::pair<float, float>> generate(std::size_t count,
+                thread_pool& pool, std::uint64_t seed, std::uint64_t stream) const;
+
+        private:
+
+            float weight(double x, double y) const;
+
+            double min_x_;
+            double min_y_;
+            double max_x_;
+            double max_y_;
+            unsigned int rounds_ = 8;
+
+            // empty means uniform
+            std::vector<float> weights_;
+            unsigned int weights_width_ = 0;
+            unsigned int weights_height_ = 0;
+
+    };
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+
+namespace growth {
+
+    /**
+     * Counter based random numbers. Each value is a pure function of a
+     * seed, a stream and a counter, the counter-th output of a SplitMix64
+     * generator keyed by the seed and stream. Any value can be computed on
+     * its own, in any order and on any thread, and is the same on every
+     * machine, so there is no generator state to share or pass around.
+     */
+    namespace rng {
+
+        // independent sequences drawn from the same seed
+        enum stream : std::uint64_t {
+            attractors = 1,
+            seeds = 2,
+            injected = 3
+        };
+
+        /**
+         * SplitMix64's finalizer, a bijection scattering nearby inputs.
+         */
+        inline std::uint64_t mix(std::uint64_t z) {
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            return z ^ (z >> 31);
+        }
+
+        /**
+         * 64 random bits for the counter in the seed's stream.
+         */
+        inline std::uint64_t bits(std::uint64_t seed, std::uint64_t stream,
+                std::uint64_t counter) {
+            constexpr std::uint64_t gamma = 0x9e3779b97f4a7c15ULL;
+            std::uint64_t key = mix(mix(seed) ^ stream);
+            return mix(key + (counter + 1) * gamma);
+        }
+
+        /**
+         * A random double in [0, 1) for the counter in the seed's stream.
+         */
+        inline double uniform(std::uint64_t seed, std::uint64_t stream,
+                std::uint64_t counter) {
+            // the top 53 bits fill a double's mantissa exactly
+            return (bits(seed, stream, counter) >> 11) * 0x1.0p-53;
+        }
+
+    }
+
+}
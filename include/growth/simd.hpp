@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace growth {
+
+    /**
+     * Batched distance kernels over contiguous coordinate arrays, used by
+     * the simulation's inner loops in place of computing one point pair at
+     * a time. Each kernel has an AVX2 or NEON implementation along with a
+     * scalar fallback, and the best one the CPU supports is picked on first
+     * use. The vector paths perform the same operations in the same order
+     * as the scalar one, so with the default floating point flags the
+     * results do not depend on which one runs.
+     *
+     * The kernels are provided for float and double coordinates.
+     */
+    namespace simd {
+
+        /**
+         * Writes the squared distance from (px, py) to each of the n points
+         * to out.
+         */
+        template <typename T>
+        void squared_distances(const T* xs, const T* ys, std::size_t n,
+            T px, T py, T* out);
+
+        /**
+         * Finds the point closest to (px, py) among the n points, skipping
+         * those whose live flag is 0 if live is given. Returns its index,
+         * the first one on ties, or n if there is none, and sets
+         * distance2 to its squared distance.
+         */
+        template <typename T>
+        std::size_t nearest(const T* xs, const T* ys, const std::uint8_t* live,
+            std::size_t n, T px, T py, T& distance2);
+
+        /**
+         * For each of the n pairs of points a and b writes the direction
+         * from b to a, normalized and then divided by the larger of their
+         * distance and min_weight, to (dx, dy). The pairs must not coincide.
+         */
+        template <typename T>
+        void directions(const T* ax, const T* ay, const T* bx, const T* by,
+            std::size_t n, T min_weight, T* dx, T* dy);
+
+        /**
+         * The name of the instruction set the kernels run with.
+         */
+        const char* isa();
+
+    }
+
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <vector>
+
+namespace growth {
+
+    /**
+     * A copy of what is drawn of the simulation at one step, so it can be
+     * drawn while the simulation moves on. The coordinates are the
+     * simulation's, stored as floats in flat arrays ready to be drawn.
+     */
+    struct snapshot {
+        // the line from each node to its parent, as x0, y0, x1, y1
+        std::vector<float> segments;
+        // the width of each line
+        std::vector<float> widths;
+        // the live attractors as x, y, empty unless asked for
+        std::vector<float> attractors;
+        float aspect_ratio = 1.0f;
+        unsigned long steps = 0;
+    };
+
+}
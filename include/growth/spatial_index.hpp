@@ -0,0 +1,179 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include <CGAL/Delaunay_triangulation_2.h>
+#include <CGAL/Triangulation_vertex_base_with_info_2.h>
+
+#include "kernel.hpp"
+
+namespace growth {
+
+    /**
+     * An index over the growth nodes' positions answering the spatial
+     * queries made by the simulation. Each point carries the id of the
+     * node it belongs to, and the index keeps a handle per id so a node
+     * can be removed without searching for it.
+     */
+    template <typename Kernel>
+    class spatial_index {
+        public:
+
+            // types from the kernel for representing the points
+            using kernel = Kernel;
+            using scalar = typename kernel::FT;
+            using point2 = typename kernel::Point_2;
+            using entry = std::pair<point2, unsigned int>;
+
+            virtual ~spatial_index() = default;
+
+            /**
+             * Adds a batch of points with their ids to the index.
+             */
+            virtual void insert(const std::vector<entry>& points) = 0;
+
+            /**
+             * Removes the point with the given id, if it is in the index.
+             */
+            virtual void remove(unsigned int id) = 0;
+
+            /**
+             * Whether the point with the given id is in the index.
+             */
+            virtual bool contains(unsigned int id) const = 0;
+
+            /**
+             * Sets id to the id of the point closest to p. The search may
+             * stop early returning false, leaving id as is, when no point
+             * is closer than radius. A point farther than radius can still
+             * be found. Returns false if the index is empty.
+             */
+            virtual bool nearest(const point2& p, scalar radius,
+                unsigned int& id) const = 0;
+
+            /**
+             * Finds the ids of the points closer to p than radius that are
+             * in its relative neighborhood, that is the points v for which
+             * no other point u is closer to both v and p than they are to
+             * each other. Used by closed venation. Does not modify the index.
+             */
+            virtual void relative_neighbors(const point2& p, scalar radius,
+                std::vector<unsigned int>& ids) const = 0;
+
+            /**
+             * Whether nearest() and relative_neighbors() may be called from
+             * several threads at once.
+             */
+            virtual bool concurrent() const = 0;
+
+    };
+
+    /**
+     * A spatial index backed by a CGAL Delaunay triangulation. The
+     * triangulation always uses CGAL's kernel for its robust predicates,
+     * points of other kernels are converted on the way in.
+     *
+     * Relative neighbors are searched for among the points that would be
+     * adjacent to p if it were inserted, read from the boundary of p's
+     * conflict zone without inserting it.
+     */
+    template <typename Kernel>
+    class delaunay_index : public spatial_index<Kernel> {
+        public:
+
+            using typename spatial_index<Kernel>::scalar;
+            using typename spatial_index<Kernel>::point2;
+            using typename spatial_index<Kernel>::entry;
+
+            using vertex_index = CGAL::Triangulation_vertex_base_with_info_2<
+                unsigned int,
+                cgal_kernel
+            >;
+            using vertex_index_data_structure = CGAL::Triangulation_data_structure_2<
+                vertex_index
+            >;
+            using delaunay_indexed = CGAL::Delaunay_triangulation_2<
+                cgal_kernel,
+                vertex_index_data_structure
+            >;
+            using vertex_handle = typename delaunay_indexed::Vertex_handle;
+
+            void insert(const std::vector<entry>& points) override;
+            void remove(unsigned int id) override;
+            bool contains(unsigned int id) const override;
+            bool nearest(const point2& p, scalar radius,
+                unsigned int& id) const override;
+            void relative_neighbors(const point2& p, scalar radius,
+                std::vector<unsigned int>& ids) const override;
+
+            // The triangulation's point location is not safe to share.
+            bool concurrent() const override { return false; }
+
+        private:
+
+            static cgal_kernel::Point_2 convert(const point2& p) {
+                return cgal_kernel::Point_2(p.x(), p.y());
+            }
+
+            delaunay_indexed graph_;
+            std::vector<vertex_handle> handles_;
+
+    };
+
+    /**
+     * A spatial index that buckets points into a uniform grid of square
+     * cells over the simulation's bounds. Each cell stores its points as
+     * contiguous arrays of ids and coordinates. Points outside the bounds
+     * are kept in the nearest border cell.
+     *
+     * Relative neighbors are found by visiting the points in order of
+     * distance from p, ring of cells by ring of cells, until the radius is
+     * reached or every direction around p is blocked by a closer point.
+     */
+    template <typename Kernel>
+    class grid_index : public spatial_index<Kernel> {
+        public:
+
+            using typename spatial_index<Kernel>::scalar;
+            using typename spatial_index<Kernel>::point2;
+            using typename spatial_index<Kernel>::entry;
+
+            grid_index(scalar min_x, scalar min_y, scalar max_x, scalar max_y,
+                scalar cell_size);
+
+            void insert(const std::vector<entry>& points) override;
+            void remove(unsigned int id) override;
+            bool contains(unsigned int id) const override;
+            bool nearest(const point2& p, scalar radius,
+                unsigned int& id) const override;
+            void relative_neighbors(const point2& p, scalar radius,
+                std::vector<unsigned int>& ids) const override;
+            bool concurrent() const override { return true; }
+
+        private:
+
+            struct cell {
+                std::vector<unsigned int> ids;
+                std::vector<scalar> xs;
+                std::vector<scalar> ys;
+            };
+
+            int column(scalar x) const;
+            int row(scalar y) const;
+
+            std::vector<cell> cells_;
+            // the cell and position in it of each id, -1 if not present
+            std::vector<int> cell_of_;
+            std::vector<unsigned int> slot_of_;
+            int columns_;
+            int rows_;
+            scalar min_x_;
+            scalar min_y_;
+            scalar max_x_;
+            scalar max_y_;
+            scalar cell_size_;
+
+    };
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace growth {
+
+    /**
+     * A fixed set of worker threads used to split the read-only phases of
+     * a simulation step across cores. Work is handed out as a range of
+     * indices, each processed exactly once by whichever thread claims it.
+     */
+    class thread_pool {
+        public:
+
+            /**
+             * Starts the given number of threads in total, including the
+             * calling thread. 0 uses the hardware concurrency.
+             */
+            explicit thread_pool(unsigned int threads = 0);
+            ~thread_pool();
+
+            thread_pool(const thread_pool&) = delete;
+            thread_pool& operator=(const thread_pool&) = delete;
+
+            /**
+             * Calls fn(i) for every i in [0, n) across the pool and blocks
+             * until all calls have returned. The calling thread takes part.
+             */
+            void parallel_for(std::size_t n, const std::function<void(std::size_t)>& fn);
+
+            // getters
+            unsigned int size() const { return workers_.size() + 1; }
+
+        private:
+
+            void work();
+            void run_tasks(const std::function<void(std::size_t)>& task, std::size_t count);
+
+            std::vector<std::thread> workers_;
+            std::mutex mutex_;
+            std::condition_variable start_;
+            std::condition_variable finished_;
+
+            const std::function<void(std::size_t)>* task_ = nullptr;
+            std::size_t count_ = 0;
+            std::atomic<std::size_t> next_{0};
+            unsigned long generation_ = 0;
+            // the workers yet to finish the current generation, a worker
+            // woken late still counts so the task can't change under it
+            unsigned int pending_ = 0;
+            bool stop_ = false;
+
+    };
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace growth {
+
+    /**
+     * Timers and counters along the simulation's hot paths, written out
+     * once per step so production runs can be profiled without attaching
+     * a profiler. They are only compiled in when GROWTH_TRACE is defined,
+     * the GROWTH_TRACE_* macros expand to nothing otherwise. Even then
+     * nothing is recorded until a trace is opened.
+     *
+     * Each step's time per phase and counts are written as a JSON object
+     * per line or a CSV row. A Chrome trace, which can be loaded in
+     * chrome://tracing or Perfetto, instead has an event per phase on the
+     * thread it ran on, and the per step totals as counters.
+     */
+    namespace trace {
+
+        using clock = std::chrono::steady_clock;
+
+        // the timed phases, update_width is too frequent to get events
+        // of its own in a Chrome trace and is only totaled per step
+        enum class phase : unsigned int {
+            step, associate, grow, consume, prune, maintain, update_width, draw
+        };
+        constexpr unsigned int num_phases = 8;
+
+        // the counted events
+        enum class counter : unsigned int {
+            attractors_visited, nearest_queries, neighbor_queries,
+            nodes_added, attractors_added, attractors_removed, nodes_pruned,
+            nodes_retired
+        };
+        constexpr unsigned int num_counters = 8;
+
+        enum class format { json_lines, csv, chrome };
+
+#ifdef GROWTH_TRACE
+        constexpr bool enabled = true;
+#else
+        constexpr bool enabled = false;
+#endif
+
+        /**
+         * Starts writing a trace to the file at path, replacing any trace
+         * already open. Returns false if the file can't be written.
+         */
+        bool open(const std::string& path, format f);
+
+        /**
+         * Finishes the trace and closes its file.
+         */
+        void close();
+
+        /**
+         * Records that the phase ran from start to end on this thread.
+         */
+        void record(phase p, clock::time_point start, clock::time_point end);
+
+        /**
+         * Adds n to the counter. Safe to call from several threads.
+         */
+        void add(counter c, std::uint64_t n);
+
+        /**
+         * Writes the totals of the step that just ended, then starts
+         * the next one from zero.
+         */
+        void end_step(unsigned long step);
+
+        /**
+         * Records the phase from its construction to its destruction.
+         */
+        class scope {
+            public:
+
+                explicit scope(phase p): phase_(p), start_(clock::now()) {}
+                ~scope() { record(phase_, start_, clock::now()); }
+
+                scope(const scope&) = delete;
+                scope& operator=(const scope&) = delete;
+
+            private:
+
+                phase phase_;
+                clock::time_point start_;
+
+        };
+
+    }
+
+}
+
+#ifdef GROWTH_TRACE
+#define GROWTH_TRACE_CONCAT_(a, b) a##b
+#define GROWTH_TRACE_NAME_(line) GROWTH_TRACE_CONCAT_(growth_trace_scope_, line)
+#define GROWTH_TRACE_SCOPE(p) \
+    ::growth::trace::scope GROWTH_TRACE_NAME_(__LINE__)(::growth::trace::phase::p)
+#define GROWTH_TRACE_COUNT(c, n) \
+    ::growth::trace::add(::growth::trace::counter::c, (n))
+#define GROWTH_TRACE_STEP(step) ::growth::trace::end_step(step)
+#else
+#define GROWTH_TRACE_SCOPE(p) ((void)0)
+#define GROWTH_TRACE_COUNT(c, n) ((void)0)
+#define GROWTH_TRACE_STEP(step) ((void)0)
+#endif
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+namespace growth {
+
+    /**
+     * Hands values from one writer thread to one reader thread without
+     * locking. The writer fills its back slot and publishes it by swapping
+     * it with the middle slot, and the reader swaps its front slot with the
+     * middle one whenever a newer value has been published there. Neither
+     * side ever waits for the other, and the reader always gets the latest
+     * complete value. Slots are reused, so values holding vectors keep
+     * their capacity from one round to the next.
+     */
+    template <typename T>
+    class triple_buffer {
+        public:
+
+            // trivial constructor and destructor
+            triple_buffer() = default;
+            ~triple_buffer() = default;
+
+            triple_buffer(const triple_buffer&) = delete;
+            triple_buffer& operator=(const triple_buffer&) = delete;
+
+            /**
+             * The slot the writer fills, left as it was when last published
+             * from. Only the writer may use it.
+             */
+            T& back() { return slots_[back_]; }
+
+            /**
+             * Publishes the back slot, giving the writer an unused one.
+             */
+            void publish() {
+                back_ = middle_.exchange(back_ | fresh, std::memory_order_acq_rel) & slot_mask;
+            }
+
+            /**
+             * Whether the reader has taken the last published value, so a
+             * writer can skip filling values that would never be read.
+             */
+            bool consumed() const {
+                return (middle_.load(std::memory_order_relaxed) & fresh) == 0;
+            }
+
+            /**
+             * Moves the latest published value to the front slot if it is
+             * newer than the one there. Returns whether it was.
+             */
+            bool update() {
+                if (consumed()) {
+                    return false;
+                }
+
+                front_ = middle_.exchange(front_, std::memory_order_acq_rel) & slot_mask;
+                return true;
+            }
+
+            /**
+             * The slot holding the reader's value. Only the reader may use it.
+             */
+            const T& front() const { return slots_[front_]; }
+
+        private:
+
+            // the middle index is flagged while it holds an unread value
+            static constexpr unsigned int slot_mask = 3;
+            static constexpr unsigned int fresh = 4;
+
+            std::array<T, 3> slots_;
+            unsigned int back_ = 0;
+            std::atomic<unsigned int> middle_{1};
+            unsigned int front_ = 2;
+
+    };
+
+}
@@ -1,16 +1,25 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <boost/gil/image.hpp>
 #include <boost/gil/typedefs.hpp>
-#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
-#include <CGAL/Delaunay_triangulation_2.h>
-#include <CGAL/Triangulation_vertex_base_with_info_2.h>
-
+#include "alias_table.hpp"
+#include "attractor_source.hpp"
+#include "attractors.hpp"
+#include "checkpoint.hpp"
+#include "kernel.hpp"
 #include "node.hpp"
+#include "snapshot.hpp"
+#include "spatial_index.hpp"
+#include "thread_pool.hpp"
 
 namespace growth {
 
@@ -18,36 +27,51 @@ namespace growth {
      * A class simulating venation growth using a space colonization algorithm.
      * It supports both open and closed venation styles, and has a number
      * of configurable parameters.
+     *
+     * All geometry goes through the Kernel, either CGAL's kernel with its
+     * robust predicates or a plain float or double scalar_kernel for
+     * faster bulk runs. The growth library is instantiated with each.
      */
-    class venation {
+    template <typename Kernel>
+    class basic_venation {
         public:
 
-            // types from CGAL used for math
-            using kernel = CGAL::Exact_predicates_inexact_constructions_kernel;
-            using vertex_index = CGAL::Triangulation_vertex_base_with_info_2<
-                unsigned int,
-                kernel
-            >;
-            using vertex_index_data_structure = CGAL::Triangulation_data_structure_2<
-                vertex_index
-            >;
-            using point2 = kernel::Point_2;
-            using vector2 = kernel::Vector_2;
-            using delaunay = CGAL::Delaunay_triangulation_2<kernel>;
-            using delaunay_indexed = CGAL::Delaunay_triangulation_2<
-                kernel, 
-                vertex_index_data_structure
-            >;
-            using attractor_handle = delaunay::Vertex_handle;
-            using node_handle = delaunay_indexed::Vertex_handle;
-            using node_circulator = delaunay_indexed::Vertex_circulator;
+            // types from the kernel used for math
+            using kernel = Kernel;
+            using scalar = typename kernel::FT;
+            using point2 = typename kernel::Point_2;
+            using vector2 = typename kernel::Vector_2;
+            using attractor_set = basic_attractor_set<Kernel>;
+            using source_type = attractor_source<Kernel>;
+            using checkpoint = basic_checkpoint<Kernel>;
+            using node_arena = basic_node_arena<Kernel>;
 
             // the types of venation
             enum type { open, closed };
 
+            // the spatial indices available for node lookups
+            enum index_type { delaunay_graph, grid };
+
+            // how the attractors are spread, independently at random or
+            // evenly spaced Poisson disk samples
+            enum placement_type { white_noise, blue_noise };
+
+            // the time spent in each phase of the steps so far, in seconds
+            struct phase_times {
+                // associating attractors with nodes and summing influences
+                double associate = 0.0;
+                double grow = 0.0;
+                // removing consumed attractors, closing loops when closed
+                double consume = 0.0;
+                double prune = 0.0;
+                // adding, waking and compacting attractors, and
+                // retiring nodes
+                double maintain = 0.0;
+            };
+
             // trivial constructor and destructor
-            venation(type mode = type::open): mode_(mode) {}
-            ~venation() = default;
+            basic_venation(type mode = type::open): mode_(mode) {}
+            ~basic_venation() = default;
 
             /**
              * Scales the simulation to fit within the provided with & height.
@@ -68,74 +92,178 @@ namespace growth {
             void update();
 
             /**
-             * Draw the attractors to the screen. Useful for debugging.
+             * Prunes every straight line of nodes from the seeds. Used to
+             * compact the tree for output when pruning has been deferred.
+             */
+            void optimize();
+
+            /**
+             * Copies the lines of the tree, and the live attractors if
+             * asked for, into the snapshot, reusing its storage.
+             */
+            void capture(snapshot& s, bool with_attractors);
+
+            /**
+             * Copies the simulation's state and parameters into the
+             * checkpoint, reusing its storage.
              */
-            void draw_attractors();
+            void save(checkpoint& c);
 
             /**
-             * Draw the growth nodes to the screen.
+             * Replaces the simulation's state and parameters with the
+             * checkpoint's, in place of setup(). The simulation then steps
+             * exactly as the one it was saved from would have. The source
+             * and the number of threads are kept. Throws a
+             * std::runtime_error, leaving the simulation as it was, if the
+             * checkpoint is corrupt.
              */
-            void draw_nodes();
+            void load(const checkpoint& c);
+
+            /**
+             * Returns true once the simulation can no longer change, that is
+             * when every attractor has been consumed or growth has stalled
+             * for more than the no growth limit consecutive steps, and the
+             * source, if any, has run dry.
+             */
+            bool converged();
 
             /**
              * Sets the width and height of the simulation.
              */
-            venation& configure(unsigned int width, unsigned int height);
+            basic_venation& configure(unsigned int width, unsigned int height);
 
             // setters
-            venation& seeds(const std::vector<point2>& seeds);
-            venation& num_attractors(unsigned int n) { num_attractors_ = n; return *this; }
-            venation& mode(type mode) { mode_ = mode; return *this; }
-            venation& mode(const std::string& m);
-            venation& growth_radius(long double r) { growth_radius_ = r; return *this; }
-            venation& growth_rate(long double r) { growth_rate_ = r; return *this; }
-            venation& consume_radius(long double r) { consume_radius_ = r; return *this; }
-            venation& mask_shades(unsigned int n) { mask_shades_ = n; return *this; }
-            venation& mask(const boost::gil::rgb8_image_t& img);
+            basic_venation& seeds(const std::vector<point2>& seeds);
+            basic_venation& num_attractors(unsigned int n) { num_attractors_ = n; return *this; }
+            basic_venation& random_seed(std::uint64_t s) { seed_ = s; return *this; }
+            basic_venation& mode(type mode) { mode_ = mode; return *this; }
+            basic_venation& mode(const std::string& m);
+            basic_venation& index(index_type i) { index_type_ = i; return *this; }
+            basic_venation& index(const std::string& i);
+            basic_venation& placement(placement_type p) { placement_ = p; return *this; }
+            basic_venation& placement(const std::string& p);
+            basic_venation& growth_radius(scalar r) { growth_radius_ = r; return *this; }
+            basic_venation& growth_rate(scalar r) { growth_rate_ = r; return *this; }
+            basic_venation& consume_radius(scalar r) { consume_radius_ = r; return *this; }
+            basic_venation& mask_shades(unsigned int n) { mask_shades_ = n; return *this; }
+            basic_venation& no_growth_limit(unsigned int n) { no_growth_limit_ = n; return *this; }
+            basic_venation& threads(unsigned int n) { threads_ = n; pool_.reset(); return *this; }
+            basic_venation& defer_pruning(bool d) { defer_pruning_ = d; return *this; }
+            basic_venation& mask(const boost::gil::rgb8_image_t& img);
+            basic_venation& mask(std::shared_ptr<const boost::gil::rgb8_image_t> img);
+
+            /**
+             * Sets the source adding attractors at the start of each step,
+             * on top of the ones generated by setup(). Candidates outside
+             * the mask, or closer than the birth radius to a node, a live
+             * attractor or another candidate, are skipped.
+             */
+            basic_venation& source(std::unique_ptr<source_type> s) { source_ = std::move(s); return *this; }
+            basic_venation& birth_radius(scalar r) { birth_radius_ = r; return *this; }
 
             // getters
-            delaunay& attractors() { return attractors_graph_; }
-            std::vector<node_ref>& nodes() { return nodes_; }
+            attractor_set& attractors() { return attractors_; }
+            node_arena& nodes() { return nodes_; }
+            // the nodes still searched, and the ones retired from the index
+            const std::vector<node_id>& front() { return front_; }
+            const std::vector<node_id>& archive() { return archive_; }
             unsigned int width() { return width_; }
             unsigned int height() { return height_; }
+            scalar aspect_ratio() { return aspect_ratio_; }
+            unsigned int num_seeds() { return seeds_.size(); }
+            unsigned int num_attractors() { return num_attractors_; }
+            unsigned long steps() { return steps_; }
+            std::uint64_t random_seed() { return seed_; }
+            const phase_times& timings() { return timings_; }
 
         private:
 
+            // number of attractors handed to a worker at a time
+            static constexpr std::size_t chunk_size = 1024;
+            // steps between passes retiring nodes from the index
+            static constexpr unsigned long retire_interval = 8;
+
+            thread_pool& pool();
+
             void prepare_mask();
             void generate_attractors();
+            std::vector<point2> random_attractors();
+            std::vector<point2> poisson_attractors();
             void create_seeds();
             
-            long double growth_radius();
-            long double growth_rate();
+            scalar growth_radius();
+            scalar growth_rate();
 
-            std::ptrdiff_t insert_node(const point2&);
+            void create_index();
+            node_id create_node(const point2&, const vector2&, node_id parent);
+            void prune();
+            void retire();
+            void restore();
+            void restore_near(const std::vector<point2>&, scalar radius);
+            void inject();
             void grow(const std::map<unsigned int, vector2>&);
-            bool has_consumed(unsigned int, const point2&);
+            bool has_consumed(node_id, const point2&);
+            void update_nearest(std::size_t);
             void open_step();
             void closed_step();
 
             type mode_;
 
-            delaunay attractors_graph_;
+            attractor_set attractors_;
+            std::unique_ptr<source_type> source_;
+            // whether the source may still add attractors
+            bool source_active_ = false;
+            scalar birth_radius_ = 0.02;
+            // the smallest radius dormant attractors were put to sleep at,
+            // none of them has a node closer than it
+            scalar sleep_radius_ = std::numeric_limits<scalar>::infinity();
 
             std::vector<point2> seeds_;
-            std::vector<node_ref> nodes_;
-            delaunay_indexed nodes_graph_;
+            node_arena nodes_;
+            // seed children that gained a child since the last pruning pass,
+            // as only their straight lines can have grown
+            std::vector<std::pair<node_id, node_id>> prune_candidates_;
+            bool defer_pruning_ = false;
+            index_type index_type_ = index_type::delaunay_graph;
+            placement_type placement_ = placement_type::white_noise;
+            std::unique_ptr<spatial_index<Kernel>> nodes_index_;
+            // The nodes in the index, and the ones retired from it as no
+            // live attractor was within the growth radius. Retired nodes
+            // stay in the arena, they are only no longer searched.
+            std::vector<node_id> front_;
+            std::vector<node_id> archive_;
+            // the smallest radius nodes were retired at
+            scalar retire_radius_ = std::numeric_limits<scalar>::infinity();
 
             unsigned int width_ = 512;
             unsigned int height_ = 512;
-            long double aspect_ratio_ = 1.0;
+            scalar aspect_ratio_ = 1.0;
             unsigned int num_attractors_ = 1000;
-            long double growth_radius_ = 0.5;
-            long double growth_rate_ = 0.002;
-            long double consume_radius_ = 0.002;
+            // every random number is drawn from it, see rng.hpp
+            std::uint64_t seed_ = 0;
+            scalar growth_radius_ = 0.5;
+            scalar growth_rate_ = 0.002;
+            scalar consume_radius_ = 0.002;
             unsigned int mask_shades_ = 2;
             bool mask_given_ = false;
             int no_growth_count_ = 0;
+            unsigned int no_growth_limit_ = 8;
+            unsigned long steps_ = 0;
+            phase_times timings_;
+            unsigned int threads_ = 0;
+            std::unique_ptr<thread_pool> pool_;
 
-            boost::gil::rgb8_image_t mask_img_;
+            // may be shared by several simulations, it is never modified
+            std::shared_ptr<const boost::gil::rgb8_image_t> mask_img_;
+            // the mask's quantized brightness, and the table of pixels
+            // random attractors are drawn from weighted by it
             std::vector<float> mask_data_;
+            unsigned int mask_width_ = 0;
+            unsigned int mask_height_ = 0;
+            alias_table mask_table_;
 
     };
 
+    using venation = basic_venation<default_kernel>;
+
 }
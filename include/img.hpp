@@ -3,16 +3,13 @@
  */
 #pragma once
 
+#include <cmath>
+#include <vector>
+
 #include <boost/gil/image.hpp>
 #include <boost/gil/typedefs.hpp>
 #include <boost/gil/extension/io/pnm.hpp>
 
-#ifdef __APPLE__
-#define GL_SILENCE_DEPRECATION
-#endif
-
-#include <GLFW/glfw3.h>
-
 namespace img {
 
     /**
@@ -46,44 +43,4 @@ namespace img {
         }
     };
 
-    /**
-     * Saves the current openGL frame buffer to the file given by filepath.
-     */
-    inline void save_frame(const std::string& filepath, GLFWwindow* window) {
-        std::cout << "Saving frame...\n";
-
-        // get window size
-        int width, height;
-        glfwGetFramebufferSize(window, &width, &height);
-
-        glPixelStorei(GL_PACK_ALIGNMENT, 4);
-        glReadBuffer(GL_FRONT);
-        
-        // get pixel data
-        GLubyte* data = (GLubyte*)malloc(width * height * 3);
-        glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, data);
-
-        // prepare image object
-        boost::gil::rgb8_image_t img(width, height);
-        const boost::gil::rgb8_view_t& viewer = boost::gil::view(img);
-
-        // copy pixel data into boost image object
-        for (int y = 0; y < viewer.height(); ++y) {
-            boost::gil::rgb8_view_t::x_iterator row = viewer.row_begin(y);
-            
-            for (int x = 0; x < viewer.width(); ++x) {
-                unsigned int index = ((height - y) * width + x) * 3;
-                boost::gil::at_c<0>(row[x]) = data[index];
-                boost::gil::at_c<1>(row[x]) = data[index + 1];
-                boost::gil::at_c<2>(row[x]) = data[index + 2];
-            }
-        }
-
-        // save image to disk
-        boost::gil::write_view(filepath, boost::gil::view(img), 
-            boost::gil::pnm_tag());
-
-        std::cout << "Output written to " << filepath << '\n';
-    }
-
 }
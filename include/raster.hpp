@@ -0,0 +1,253 @@
+/**
+ * A small software rasterizer used to draw the simulation without an
+ * OpenGL context, i.e. when running headless, and to draw it at sizes
+ * far beyond the screen's.
+ */
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/gil/image.hpp>
+#include <boost/gil/typedefs.hpp>
+
+#include "growth/thread_pool.hpp"
+#include "growth/trace.hpp"
+#include "growth/venation.hpp"
+
+namespace raster {
+
+    /**
+     * Draws an anti-aliased line of the given width in pixels from (x0, y0)
+     * to (x1, y1) in pixel coordinates. Each pixel whose center lies within
+     * half the width of the segment is lit, with a one pixel falloff at the
+     * edge. Overlapping lines are combined with max so joints do not show
+     * seams.
+     *
+     * The view may be a tile of a larger image whose top left pixel is at
+     * (origin_x, origin_y), the line's coordinates being in the larger
+     * image's pixels.
+     */
+    inline void draw_line(const boost::gil::rgb8_view_t& view,
+            double x0, double y0, double x1, double y1, double width,
+            const boost::gil::rgb8_pixel_t& color, int origin_x = 0,
+            int origin_y = 0) {
+        double half_width = std::max(width, 1.0) * 0.5;
+
+        // bounding box of the capsule, clipped to the view
+        int min_x = std::max(origin_x,
+            (int)std::floor(std::min(x0, x1) - half_width - 1.0));
+        int max_x = std::min(origin_x + (int)view.width() - 1,
+            (int)std::ceil(std::max(x0, x1) + half_width + 1.0));
+        int min_y = std::max(origin_y,
+            (int)std::floor(std::min(y0, y1) - half_width - 1.0));
+        int max_y = std::min(origin_y + (int)view.height() - 1,
+            (int)std::ceil(std::max(y0, y1) + half_width + 1.0));
+
+        double dx = x1 - x0;
+        double dy = y1 - y0;
+        double length_squared = dx * dx + dy * dy;
+
+        for (int y = min_y; y <= max_y; ++y) {
+            auto row = view.row_begin(y - origin_y);
+
+            for (int x = min_x; x <= max_x; ++x) {
+                // distance from the pixel center to the segment
+                double px = x + 0.5 - x0;
+                double py = y + 0.5 - y0;
+                double t = length_squared > 0.0
+                    ? std::clamp((px * dx + py * dy) / length_squared, 0.0, 1.0)
+                    : 0.0;
+                double ex = px - t * dx;
+                double ey = py - t * dy;
+                double dist = std::sqrt(ex * ex + ey * ey);
+
+                double coverage = std::clamp(half_width + 0.5 - dist, 0.0, 1.0);
+                if (coverage <= 0.0) {
+                    continue;
+                }
+
+                auto& pixel = row[x - origin_x];
+                for (int c = 0; c < 3; ++c) {
+                    auto value = (unsigned char)std::round(coverage * color[c]);
+                    pixel[c] = std::max(pixel[c], value);
+                }
+            }
+        }
+    }
+
+    /**
+     * Converts a simulation point to pixel coordinates in a view of the
+     * given size, matching the mapping used by the OpenGL renderer.
+     */
+    inline void to_pixel(const growth::venation::point2& p, double aspect_ratio,
+            int width, int height, double& x, double& y) {
+        x = (p.x() / aspect_ratio * 0.5 + 0.5) * width;
+        y = (0.5 - p.y() * 0.5) * height;
+    }
+
+    /**
+     * A line to draw in the pixels of the output, its width and color.
+     */
+    struct segment {
+        double x0, y0, x1, y1;
+        double width;
+        boost::gil::rgb8_pixel_t color;
+    };
+
+    /**
+     * Collects the simulation's nodes, and its attractors if asked to, as
+     * segments in an image of the given size, the widths scaled by scale.
+     * Each node is drawn as a line from its parent as wide as the node,
+     * each attractor as a red dot, a segment of no length.
+     */
+    inline std::vector<segment> collect_segments(growth::venation& v, int width,
+            int height, double scale, bool show_attractors) {
+        std::vector<segment> segments;
+        double x0, y0, x1, y1;
+
+        if (show_attractors) {
+            auto& attractors = v.attractors();
+            for (std::size_t i = 0; i < attractors.size(); ++i) {
+                if (!attractors.alive(i)) {
+                    continue;
+                }
+
+                to_pixel(attractors.position(i), v.aspect_ratio(), width, height, x0, y0);
+                segments.push_back({ x0, y0, x0, y0, 5.0 * scale,
+                    boost::gil::rgb8_pixel_t(255, 0, 0) });
+            }
+        }
+
+        auto& nodes = v.nodes();
+        for (unsigned i = 0; i < v.num_seeds(); ++i) {
+            std::vector<growth::node_id> to_visit = { i };
+
+            while (!to_visit.empty()) {
+                auto node = to_visit.back();
+                to_visit.pop_back();
+
+                to_pixel(nodes.position(node), v.aspect_ratio(), width, height, x0, y0);
+
+                for (auto child = nodes.first_child[node]; child != growth::no_node;
+                        child = nodes.next_sibling[child]) {
+                    to_visit.push_back(child);
+
+                    to_pixel(nodes.position(child), v.aspect_ratio(), width, height, x1, y1);
+                    segments.push_back({ x0, y0, x1, y1, nodes.width[child] * 3.0 * scale,
+                        boost::gil::rgb8_pixel_t(255, 255, 255) });
+                }
+            }
+        }
+
+        return segments;
+    }
+
+    /**
+     * Renders the simulation scale times its configured size and writes
+     * it to out as a binary PNM, for sizes too large to draw on screen or
+     * hold in memory. The segments are first binned to the square tiles
+     * they touch. Then each row of tiles is drawn, its tiles in parallel
+     * across the given number of threads, 0 using every core, and written
+     * out before the next is started, so only one row of tiles is ever
+     * held. Lines are combined with max, so the image does not depend on
+     * the tiling or the number of threads.
+     */
+    inline void render_tiled(growth::venation& v, std::ostream& out,
+            double scale = 1.0, unsigned int threads = 0,
+            bool show_attractors = false, int tile_size = 256) {
+        GROWTH_TRACE_SCOPE(draw);
+        int width = (int)std::round(v.width() * scale);
+        int height = (int)std::round(v.height() * scale);
+        int columns = (width + tile_size - 1) / tile_size;
+        int rows = (height + tile_size - 1) / tile_size;
+
+        auto segments = collect_segments(v, width, height, scale, show_attractors);
+
+        // the tiles each segment's bounding box, as draw_line finds it,
+        // overlaps, clipped to the image
+        auto tiles = [&](const segment& s, int& min_column, int& max_column,
+                int& min_row, int& max_row) {
+            double half_width = std::max(s.width, 1.0) * 0.5;
+            int min_x = std::max(0, (int)std::floor(std::min(s.x0, s.x1) - half_width - 1.0));
+            int max_x = std::min(width - 1, (int)std::ceil(std::max(s.x0, s.x1) + half_width + 1.0));
+            int min_y = std::max(0, (int)std::floor(std::min(s.y0, s.y1) - half_width - 1.0));
+            int max_y = std::min(height - 1, (int)std::ceil(std::max(s.y0, s.y1) + half_width + 1.0));
+            min_column = min_x / tile_size;
+            max_column = max_x / tile_size;
+            min_row = min_y / tile_size;
+            max_row = max_y / tile_size;
+            return min_x <= max_x && min_y <= max_y;
+        };
+
+        // bin the segments by tile, counting them first so the bins are
+        // ranges of a single array
+        std::vector<std::uint32_t> starts(columns * rows + 1, 0);
+        int min_column, max_column, min_row, max_row;
+
+        for (const auto& s : segments) {
+            if (!tiles(s, min_column, max_column, min_row, max_row)) {
+                continue;
+            }
+            for (int row = min_row; row <= max_row; ++row) {
+                for (int column = min_column; column <= max_column; ++column) {
+                    ++starts[row * columns + column + 1];
+                }
+            }
+        }
+
+        for (std::size_t t = 1; t < starts.size(); ++t) {
+            starts[t] += starts[t - 1];
+        }
+
+        std::vector<std::uint32_t> bins(starts.back());
+        std::vector<std::uint32_t> ends(starts.begin(), starts.end() - 1);
+
+        for (std::uint32_t i = 0; i < segments.size(); ++i) {
+            if (!tiles(segments[i], min_column, max_column, min_row, max_row)) {
+                continue;
+            }
+            for (int row = min_row; row <= max_row; ++row) {
+                for (int column = min_column; column <= max_column; ++column) {
+                    bins[ends[row * columns + column]++] = i;
+                }
+            }
+        }
+
+        // the same header as boost::gil's pnm writer
+        out << "P6 " << width << ' ' << height << " 255 ";
+
+        growth::thread_pool pool(threads);
+        boost::gil::rgb8_image_t band(width, std::min(tile_size, height));
+
+        for (int row = 0; row < rows; ++row) {
+            int top = row * tile_size;
+            int band_height = std::min(tile_size, height - top);
+            auto band_view = boost::gil::subimage_view(boost::gil::view(band),
+                0, 0, width, band_height);
+
+            pool.parallel_for(columns, [&](std::size_t column) {
+                int left = column * tile_size;
+                auto tile = boost::gil::subimage_view(band_view, left, 0,
+                    std::min(tile_size, width - left), band_height);
+                boost::gil::fill_pixels(tile, boost::gil::rgb8_pixel_t(0, 0, 0));
+
+                std::size_t t = row * columns + column;
+                for (auto i = starts[t]; i < starts[t + 1]; ++i) {
+                    const auto& s = segments[bins[i]];
+                    draw_line(tile, s.x0, s.y0, s.x1, s.y1, s.width, s.color, left, top);
+                }
+            });
+
+            for (int y = 0; y < band_height; ++y) {
+                out.write(reinterpret_cast<const char*>(&band_view.row_begin(y)[0]),
+                    width * sizeof(boost::gil::rgb8_pixel_t));
+            }
+        }
+    }
+
+}
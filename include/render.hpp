@@ -0,0 +1,97 @@
+/**
+ * OpenGL drawing helpers for the interactive window. These are kept out of
+ * the growth library so that it can be used without an OpenGL context.
+ */
+#pragma once
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/gil/image.hpp>
+#include <boost/gil/typedefs.hpp>
+#include <boost/gil/extension/io/pnm.hpp>
+
+#ifdef __APPLE__
+#define GL_SILENCE_DEPRECATION
+#endif
+
+#include <GLFW/glfw3.h>
+
+#include "growth/snapshot.hpp"
+
+namespace render {
+
+    /**
+     * Draw the snapshot's attractors to the screen. Useful for debugging.
+     */
+    inline void draw_attractors(const growth::snapshot& s) {
+        glPointSize(5.0f);
+        glBegin(GL_POINTS);
+            glColor3f(1.0f, 0.0f, 0.0f);
+            for (std::size_t i = 0; i < s.attractors.size(); i += 2) {
+                glVertex2f(s.attractors[i] / s.aspect_ratio, s.attractors[i + 1]);
+            }
+        glEnd();
+    }
+
+    /**
+     * Draw the snapshot's growth nodes to the screen.
+     */
+    inline void draw_nodes(const growth::snapshot& s) {
+        glColor3f(1.0f, 1.0f, 1.0f);
+
+        // draw a line from each parent to its child
+        for (std::size_t i = 0; i < s.widths.size(); ++i) {
+            const float* segment = &s.segments[i * 4];
+
+            glLineWidth(s.widths[i] * 3.0f);
+            glBegin(GL_LINES);
+                glVertex2f(segment[0] / s.aspect_ratio, segment[1]);
+                glVertex2f(segment[2] / s.aspect_ratio, segment[3]);
+            glEnd();
+        }
+    }
+
+    /**
+     * Saves the current openGL frame buffer to the file given by filepath.
+     */
+    inline void save_frame(const std::string& filepath, GLFWwindow* window) {
+        std::cout << "Saving frame...\n";
+
+        // get window size
+        int width, height;
+        glfwGetFramebufferSize(window, &width, &height);
+
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        glReadBuffer(GL_FRONT);
+
+        // get pixel data
+        GLubyte* data = (GLubyte*)malloc(width * height * 3);
+        glReadPixels(0, 0, width, height, GL_RGB, GL_UNSIGNED_BYTE, data);
+
+        // prepare image object
+        boost::gil::rgb8_image_t img(width, height);
+        const boost::gil::rgb8_view_t& viewer = boost::gil::view(img);
+
+        // copy pixel data into boost image object
+        for (int y = 0; y < viewer.height(); ++y) {
+            boost::gil::rgb8_view_t::x_iterator row = viewer.row_begin(y);
+
+            for (int x = 0; x < viewer.width(); ++x) {
+                unsigned int index = ((height - y) * width + x) * 3;
+                boost::gil::at_c<0>(row[x]) = data[index];
+                boost::gil::at_c<1>(row[x]) = data[index + 1];
+                boost::gil::at_c<2>(row[x]) = data[index + 2];
+            }
+        }
+
+        // save image to disk
+        boost::gil::write_view(filepath, boost::gil::view(img),
+            boost::gil::pnm_tag());
+
+        std::cout << "Output written to " << filepath << '\n';
+    }
+
+}
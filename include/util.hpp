@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cmath>
 
 #include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
 #include <CGAL/squared_distance_2.h>
@@ -11,20 +12,22 @@ namespace util {
     using point2 = kernel::Point_2;
     using vector2 = kernel::Vector_2;
 
-    inline kernel::FT length(const vector2& p) {
+    // The geometry helpers take any kernel's points and vectors,
+    // squared_distance is found through the point type's namespace.
+
+    template <typename V>
+    inline auto length(const V& p) {
         return std::sqrt(p.squared_length());
     }
 
-    inline vector2 normalize(const vector2& p) {
+    template <typename V>
+    inline V normalize(const V& p) {
         return p / length(p);
     }
 
-    inline kernel::FT distance(const point2& a, const point2& b) {
-        return std::sqrt(CGAL::squared_distance(a, b));
-    }
-
-    inline kernel::FT rnd() {
-        return static_cast <kernel::FT> (rand()) / static_cast <kernel::FT> (RAND_MAX);
+    template <typename P>
+    inline auto distance(const P& a, const P& b) {
+        return std::sqrt(squared_distance(a, b));
     }
 
 }
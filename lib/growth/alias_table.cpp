@@ -0,0 +1,59 @@
+#include "growth/alias_table.hpp"
+
+using namespace growth;
+
+alias_table::alias_table(const std::vector<float>& weights) {
+    double total = 0.0;
+    for (const auto w : weights) {
+        total += w;
+    }
+
+    if (!(total > 0.0)) {
+        return;
+    }
+
+    std::size_t n = weights.size();
+    probability_.resize(n);
+    alias_.resize(n);
+
+    // each weight scaled so that they average to 1
+    std::vector<double> scaled(n);
+    std::vector<std::uint32_t> small;
+    std::vector<std::uint32_t> large;
+
+    for (std::size_t i = 0; i < n; ++i) {
+        scaled[i] = weights[i] * (n / total);
+        if (scaled[i] < 1.0) {
+            small.push_back(i);
+        } else {
+            large.push_back(i);
+        }
+    }
+
+    // pair each index short of 1 with one over it, which tops it up
+    while (!small.empty() && !large.empty()) {
+        std::uint32_t s = small.back();
+        std::uint32_t l = large.back();
+        small.pop_back();
+
+        probability_[s] = scaled[s];
+        alias_[s] = l;
+
+        scaled[l] -= 1.0 - scaled[s];
+        if (scaled[l] < 1.0) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+
+    // whatever is left is 1 up to rounding
+    for (const auto i : large) {
+        probability_[i] = 1.0f;
+        alias_[i] = i;
+    }
+
+    for (const auto i : small) {
+        probability_[i] = 1.0f;
+        alias_[i] = i;
+    }
+}
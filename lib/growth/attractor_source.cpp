@@ -0,0 +1,26 @@
+#include "growth/attractor_source.hpp"
+#include "growth/rng.hpp"
+
+using namespace growth;
+
+template <typename Kernel>
+bool expanding_source<Kernel>::next(unsigned long step, std::vector<point2>& points) {
+    if (step > steps_) {
+        return false;
+    }
+
+    double scale = double(step) / steps_;
+
+    for (unsigned int k = 0; k < per_step_; ++k) {
+        std::uint64_t counter = 2 * ((step - 1) * per_step_ + k);
+        double x = rng::uniform(seed_, rng::injected, counter) * 2.0 - 1.0;
+        double y = rng::uniform(seed_, rng::injected, counter + 1) * 2.0 - 1.0;
+        points.push_back(point2(x * scale, y * scale));
+    }
+
+    return step < steps_;
+}
+
+template class growth::expanding_source<growth::float_kernel>;
+template class growth::expanding_source<growth::double_kernel>;
+template class growth::expanding_source<growth::cgal_kernel>;
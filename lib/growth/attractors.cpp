@@ -0,0 +1,288 @@
+#include <algorithm>
+#include <cmath>
+
+#include "growth/attractors.hpp"
+
+using namespace growth;
+
+namespace {
+
+    /**
+     * The distance from v to cell k of count along one axis. The border
+     * cells reach out past the bounds, as they hold the points beyond them.
+     */
+    template <typename T>
+    T gap(T v, T min, T size, int k, int count) {
+        T low = min + k * size;
+        T high = low + size;
+
+        if (k > 0 && v < low) {
+            return low - v;
+        } else if (k < count - 1 && v > high) {
+            return v - high;
+        }
+
+        return 0;
+    }
+
+}
+
+template <typename Kernel>
+void basic_attractor_set<Kernel>::insert(const std::vector<point2>& points) {
+    std::size_t first = x.size();
+    std::size_t n = x.size() + points.size();
+    x.reserve(n);
+    y.reserve(n);
+
+    for (const auto& p : points) {
+        x.push_back(p.x());
+        y.push_back(p.y());
+    }
+
+    live.resize(n, 1);
+    dormant.resize(n, 0);
+    nearest_node.resize(n, 0);
+    nearest_distance.resize(n, 0.0);
+    nearest_seen.resize(n, 0);
+
+    // the new indices are past every active one, so the list stays in order
+    for (std::size_t i = first; i < n; ++i) {
+        active_.push_back(i);
+        if (columns_ > 0) {
+            ++counts_[cell(i)];
+        }
+    }
+}
+
+template <typename Kernel>
+void basic_attractor_set<Kernel>::remove(std::size_t i) {
+    if (live[i]) {
+        live[i] = 0;
+        ++dead_;
+
+        if (columns_ > 0) {
+            --counts_[cell(i)];
+        }
+    }
+}
+
+template <typename Kernel>
+bool basic_attractor_set<Kernel>::compact() {
+    if (dead_ == 0 || dead_ <= max_dead_fraction_ * x.size()) {
+        return false;
+    }
+
+    // move each live attractor down over the dead ones before it
+    std::size_t j = 0;
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        if (!live[i]) {
+            continue;
+        }
+
+        x[j] = x[i];
+        y[j] = y[i];
+        dormant[j] = dormant[i];
+        nearest_node[j] = nearest_node[i];
+        nearest_distance[j] = nearest_distance[i];
+        nearest_seen[j] = nearest_seen[i];
+        ++j;
+    }
+
+    x.resize(j);
+    y.resize(j);
+    live.assign(j, 1);
+    dormant.resize(j);
+    nearest_node.resize(j);
+    nearest_distance.resize(j);
+    nearest_seen.resize(j);
+    dead_ = 0;
+
+    // every index has moved, rebuild the active list and the grid
+    active_.clear();
+    woken_.clear();
+    for (auto& cell : cells_) {
+        cell.clear();
+    }
+    num_dormant_ = 0;
+
+    for (std::size_t i = 0; i < j; ++i) {
+        if (dormant[i]) {
+            bucket(i);
+        } else {
+            active_.push_back(i);
+        }
+    }
+
+    return true;
+}
+
+template <typename Kernel>
+void basic_attractor_set<Kernel>::clear() {
+    x.clear();
+    y.clear();
+    live.clear();
+    dormant.clear();
+    nearest_node.clear();
+    nearest_distance.clear();
+    nearest_seen.clear();
+    dead_ = 0;
+
+    active_.clear();
+    woken_.clear();
+    for (auto& cell : cells_) {
+        cell.clear();
+    }
+    std::fill(counts_.begin(), counts_.end(), 0);
+    num_dormant_ = 0;
+}
+
+template <typename Kernel>
+void basic_attractor_set<Kernel>::partition(scalar min_x, scalar min_y,
+        scalar max_x, scalar max_y, scalar cell_size) {
+    wake_all();
+    settle();
+
+    min_x_ = min_x;
+    min_y_ = min_y;
+    cell_size_ = cell_size;
+    columns_ = std::max(1, (int)std::ceil((max_x - min_x) / cell_size));
+    rows_ = std::max(1, (int)std::ceil((max_y - min_y) / cell_size));
+    cells_.assign(columns_ * rows_, {});
+    counts_.assign(columns_ * rows_, 0);
+
+    for (std::size_t i = 0; i < x.size(); ++i) {
+        if (live[i]) {
+            ++counts_[cell(i)];
+        }
+    }
+}
+
+template <typename Kernel>
+int basic_attractor_set<Kernel>::column(scalar x) const {
+    return std::clamp((int)std::floor((x - min_x_) / cell_size_), 0, columns_ - 1);
+}
+
+template <typename Kernel>
+int basic_attractor_set<Kernel>::row(scalar y) const {
+    return std::clamp((int)std::floor((y - min_y_) / cell_size_), 0, rows_ - 1);
+}
+
+template <typename Kernel>
+std::size_t basic_attractor_set<Kernel>::cell(std::size_t i) const {
+    return row(y[i]) * columns_ + column(x[i]);
+}
+
+template <typename Kernel>
+void basic_attractor_set<Kernel>::bucket(std::size_t i) {
+    cells_[cell(i)].push_back(i);
+    ++num_dormant_;
+}
+
+template <typename Kernel>
+void basic_attractor_set<Kernel>::wake_one(std::size_t i) {
+    dormant[i] = 0;
+    nearest_seen[i] = 0;
+    woken_.push_back(i);
+    --num_dormant_;
+}
+
+template <typename Kernel>
+void basic_attractor_set<Kernel>::wake(scalar px, scalar py, scalar radius) {
+    if (num_dormant_ == 0) {
+        return;
+    }
+
+    scalar radius2 = radius * radius;
+
+    for (int j = row(py - radius); j <= row(py + radius); ++j) {
+        for (int i = column(px - radius); i <= column(px + radius); ++i) {
+            auto& cell = cells_[j * columns_ + i];
+
+            for (std::size_t k = 0; k < cell.size();) {
+                std::size_t a = cell[k];
+                scalar dx = x[a] - px;
+                scalar dy = y[a] - py;
+
+                if (dx * dx + dy * dy < radius2) {
+                    wake_one(a);
+                    cell[k] = cell.back();
+                    cell.pop_back();
+                } else {
+                    ++k;
+                }
+            }
+        }
+    }
+}
+
+template <typename Kernel>
+void basic_attractor_set<Kernel>::wake_all() {
+    if (num_dormant_ == 0) {
+        return;
+    }
+
+    for (auto& cell : cells_) {
+        for (const auto a : cell) {
+            wake_one(a);
+        }
+
+        cell.clear();
+    }
+}
+
+template <typename Kernel>
+void basic_attractor_set<Kernel>::settle() {
+    std::size_t j = 0;
+
+    for (const auto a : active_) {
+        if (!live[a]) {
+            continue;
+        }
+
+        if (dormant[a]) {
+            bucket(a);
+        } else {
+            active_[j++] = a;
+        }
+    }
+
+    active_.resize(j);
+
+    if (woken_.size() > 0) {
+        std::sort(woken_.begin(), woken_.end());
+        std::size_t middle = active_.size();
+        active_.insert(active_.end(), woken_.begin(), woken_.end());
+        std::inplace_merge(active_.begin(), active_.begin() + middle, active_.end());
+        woken_.clear();
+    }
+}
+
+template <typename Kernel>
+bool basic_attractor_set<Kernel>::any_within(scalar px, scalar py, scalar radius) const {
+    if (columns_ == 0) {
+        return true;
+    }
+
+    scalar radius2 = radius * radius;
+
+    for (int j = row(py - radius); j <= row(py + radius); ++j) {
+        scalar dy = gap(py, min_y_, cell_size_, j, rows_);
+
+        for (int i = column(px - radius); i <= column(px + radius); ++i) {
+            if (counts_[j * columns_ + i] == 0) {
+                continue;
+            }
+
+            scalar dx = gap(px, min_x_, cell_size_, i, columns_);
+            if (dx * dx + dy * dy < radius2) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+template class growth::basic_attractor_set<growth::float_kernel>;
+template class growth::basic_attractor_set<growth::double_kernel>;
+template class growth::basic_attractor_set<growth::cgal_kernel>;
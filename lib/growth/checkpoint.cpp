@@ -0,0 +1,412 @@
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "growth/checkpoint.hpp"
+
+using namespace growth;
+
+namespace {
+
+    const char magic[8] = { 'G', 'R', 'O', 'W', 'T', 'H', 'C', 'K' };
+    constexpr std::uint32_t byte_order = 0x01020304;
+    constexpr std::uint64_t alignment = 64;
+
+    struct header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t scalar_size;
+        std::uint32_t byte_order;
+        std::uint32_t num_sections;
+    };
+
+    // section 0 holds the parameters, the columns follow in order
+    struct section {
+        std::uint32_t id;
+        std::uint32_t element_size;
+        std::uint64_t offset;
+        std::uint64_t count;
+    };
+
+    std::uint64_t align(std::uint64_t offset) {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+
+    /**
+     * Calls f with each of the checkpoint's columns, in the order of
+     * their sections.
+     */
+    template <typename Checkpoint, typename F>
+    void for_each_column(Checkpoint& c, F&& f) {
+        f(c.node_x);
+        f(c.node_y);
+        f(c.node_dx);
+        f(c.node_dy);
+        f(c.node_width);
+        f(c.node_parent);
+        f(c.node_first_child);
+        f(c.node_next_sibling);
+        f(c.node_live);
+        f(c.attractor_x);
+        f(c.attractor_y);
+        f(c.attractor_dormant);
+        f(c.attractor_nearest_node);
+        f(c.attractor_nearest_distance);
+        f(c.attractor_nearest_seen);
+        f(c.seeds);
+        f(c.prune_candidates);
+        f(c.front);
+        f(c.archive);
+        f(c.mask_data);
+    }
+
+    /**
+     * Writes all of the bytes, retrying partial and interrupted writes.
+     * Returns false on any other failure.
+     */
+    bool write_all(int fd, const void* data, std::size_t size) {
+        auto bytes = static_cast<const char*>(data);
+
+        while (size > 0) {
+            ssize_t written = ::write(fd, bytes, size);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+
+            bytes += written;
+            size -= written;
+        }
+
+        return true;
+    }
+
+    /**
+     * Syncs the directory holding the file at path, making a rename into
+     * it durable. Filesystems that can't sync a directory are left be.
+     */
+    void sync_directory(const std::string& path) {
+        auto slash = path.rfind('/');
+        std::string directory = slash == std::string::npos ? "."
+            : slash == 0 ? "/" : path.substr(0, slash);
+
+        int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+        if (fd >= 0) {
+            ::fsync(fd);
+            ::close(fd);
+        }
+    }
+
+    /**
+     * A read-only mapping of a whole file, unmapped when destroyed.
+     */
+    class mapping {
+        public:
+
+            explicit mapping(const std::string& path) {
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    throw std::runtime_error("could not open '" + path + "'");
+                }
+
+                struct stat st;
+                if (fstat(fd, &st) == 0 && st.st_size > 0) {
+                    size_ = st.st_size;
+                    data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                }
+
+                ::close(fd);
+
+                if (data_ == nullptr || data_ == MAP_FAILED) {
+                    data_ = nullptr;
+                    throw std::runtime_error("could not map '" + path + "'");
+                }
+            }
+
+            ~mapping() {
+                if (data_ != nullptr) {
+                    munmap(data_, size_);
+                }
+            }
+
+            mapping(const mapping&) = delete;
+            mapping& operator=(const mapping&) = delete;
+
+            const char* data() const { return static_cast<const char*>(data_); }
+            std::size_t size() const { return size_; }
+
+        private:
+
+            void* data_ = nullptr;
+            std::size_t size_ = 0;
+
+    };
+
+}
+
+template <typename Kernel>
+void basic_checkpoint<Kernel>::write(const std::string& path) const {
+    std::vector<section> sections;
+    std::vector<const void*> data;
+
+    sections.push_back({ 0, sizeof(parameters), 0, 1 });
+    data.push_back(&params);
+
+    for_each_column(*this, [&](const auto& column) {
+        using element = typename std::decay_t<decltype(column)>::value_type;
+        sections.push_back({ (std::uint32_t)sections.size(), sizeof(element), 0, column.size() });
+        data.push_back(column.data());
+    });
+
+    std::uint64_t offset = align(sizeof(header) + sections.size() * sizeof(section));
+    for (auto& s : sections) {
+        s.offset = offset;
+        offset = align(offset + s.element_size * s.count);
+    }
+
+    header h;
+    std::memcpy(h.magic, magic, sizeof(magic));
+    h.version = version;
+    h.scalar_size = sizeof(scalar);
+    h.byte_order = byte_order;
+    h.num_sections = sections.size();
+
+    // written next to the file and synced to disk, then moved over it,
+    // so a crash leaves either the old checkpoint or the new one
+    std::string temporary = path + ".tmp";
+    int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    bool ok = fd >= 0;
+
+    ok = ok && write_all(fd, &h, sizeof(h));
+    ok = ok && write_all(fd, sections.data(), sections.size() * sizeof(section));
+
+    std::uint64_t position = sizeof(h) + sections.size() * sizeof(section);
+    const char padding[alignment] = {};
+
+    for (std::size_t i = 0; ok && i < sections.size(); ++i) {
+        ok = write_all(fd, padding, sections[i].offset - position);
+        std::uint64_t bytes = sections[i].element_size * sections[i].count;
+        ok = ok && write_all(fd, data[i], bytes);
+        position = sections[i].offset + bytes;
+    }
+
+    ok = ok && ::fsync(fd) == 0;
+    if (fd >= 0) {
+        ok = ::close(fd) == 0 && ok;
+    }
+
+    if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        throw std::runtime_error("could not write the checkpoint to '" + path + "'");
+    }
+
+    // and the rename itself
+    sync_directory(path);
+}
+
+template <typename Kernel>
+void basic_checkpoint<Kernel>::read(const std::string& path) {
+    mapping file(path);
+
+    header h;
+    if (file.size() < sizeof(h)) {
+        throw std::runtime_error("'" + path + "' is not a checkpoint");
+    }
+
+    std::memcpy(&h, file.data(), sizeof(h));
+    if (std::memcmp(h.magic, magic, sizeof(magic)) != 0) {
+        throw std::runtime_error("'" + path + "' is not a checkpoint");
+    }
+
+    if (h.byte_order != byte_order) {
+        throw std::runtime_error("'" + path + "' was written on a machine "
+            "with a different byte order");
+    }
+
+    if (h.version != version) {
+        throw std::runtime_error("'" + path + "' is a version "
+            + std::to_string(h.version) + " checkpoint, expected version "
+            + std::to_string(version));
+    }
+
+    if (h.scalar_size != sizeof(scalar)) {
+        throw std::runtime_error("'" + path + "' was written with "
+            + std::to_string(h.scalar_size * 8) + " bit scalars, this build uses "
+            + std::to_string(sizeof(scalar) * 8) + " bit scalars");
+    }
+
+    if ((file.size() - sizeof(h)) / sizeof(section) < h.num_sections) {
+        throw std::runtime_error("'" + path + "' is truncated");
+    }
+
+    std::vector<section> sections(h.num_sections);
+    std::memcpy(sections.data(), file.data() + sizeof(h), h.num_sections * sizeof(section));
+
+    // the section with the id, checked to hold elements of the size
+    auto find = [&](std::uint32_t id, std::uint32_t element_size) -> const section& {
+        for (const auto& s : sections) {
+            if (s.id != id) {
+                continue;
+            }
+
+            // written so a huge offset or count can't overflow past the check
+            if (s.element_size != element_size || s.offset > file.size()
+                    || s.count > (file.size() - s.offset) / s.element_size) {
+                throw std::runtime_error("'" + path + "' is corrupt");
+            }
+
+            return s;
+        }
+
+        throw std::runtime_error("'" + path + "' is missing section "
+            + std::to_string(id));
+    };
+
+    const auto& p = find(0, sizeof(parameters));
+    std::memcpy(&params, file.data() + p.offset, sizeof(parameters));
+
+    std::uint32_t id = 1;
+    for_each_column(*this, [&](auto& column) {
+        using element = typename std::decay_t<decltype(column)>::value_type;
+        const auto& s = find(id++, sizeof(element));
+        column.resize(s.count);
+        if (s.count > 0) {
+            std::memcpy(column.data(), file.data() + s.offset, s.count * sizeof(element));
+        }
+    });
+
+    auto problem = validate();
+    if (!problem.empty()) {
+        throw std::runtime_error("'" + path + "' is corrupt, " + problem);
+    }
+}
+
+template <typename Kernel>
+std::string basic_checkpoint<Kernel>::validate() const {
+    const auto& p = params;
+    std::size_t nodes = node_x.size();
+
+    if (p.mode > 1 || p.index > 1 || p.placement > 1) {
+        return "unknown mode, index or placement";
+    }
+
+    if (p.width == 0 || p.height == 0 || !(p.aspect_ratio > 0.0)
+            || !std::isfinite(p.aspect_ratio)) {
+        return "invalid size";
+    }
+
+    // the spatial structures are sized from these
+    if (!(p.growth_radius > 0.0) || !std::isfinite(p.growth_radius)
+            || !(p.consume_radius > 0.0) || !std::isfinite(p.consume_radius)) {
+        return "invalid growth or consume radius";
+    }
+
+    if (node_y.size() != nodes || node_dx.size() != nodes || node_dy.size() != nodes
+            || node_width.size() != nodes || node_parent.size() != nodes
+            || node_first_child.size() != nodes || node_next_sibling.size() != nodes
+            || node_live.size() != nodes) {
+        return "node columns of different lengths";
+    }
+
+    if (nodes >= no_node) {
+        return "too many nodes";
+    }
+
+    auto valid = [&](node_id n) { return n == no_node || n < nodes; };
+    auto all_valid = [&](const std::vector<node_id>& ids, bool allow_none) {
+        return std::all_of(ids.begin(), ids.end(), [&](node_id n) {
+            return n < nodes || (allow_none && n == no_node);
+        });
+    };
+
+    if (!all_valid(node_parent, true) || !all_valid(node_first_child, true)
+            || !all_valid(node_next_sibling, true)) {
+        return "node link out of range";
+    }
+
+    // Every live node's children are live, link back to it and were
+    // created after it, which also rules out cycles. A list longer than
+    // the arena must loop.
+    for (node_id n = 0; n < nodes; ++n) {
+        if (!node_live[n]) {
+            continue;
+        }
+
+        std::size_t steps = 0;
+        for (node_id c = node_first_child[n]; c != no_node; c = node_next_sibling[c]) {
+            if (!node_live[c] || node_parent[c] != n || c <= n || ++steps > nodes) {
+                return "inconsistent node links";
+            }
+        }
+
+        node_id parent = node_parent[n];
+        if (parent != no_node && (!node_live[parent] || parent >= n)) {
+            return "inconsistent node links";
+        }
+    }
+
+    if (seeds.size() % 2 != 0 || seeds.size() / 2 > nodes) {
+        return "invalid seeds";
+    }
+
+    for (node_id seed = 0; seed < seeds.size() / 2; ++seed) {
+        if (!node_live[seed] || node_parent[seed] != no_node) {
+            return "invalid seeds";
+        }
+    }
+
+    if (prune_candidates.size() % 2 != 0 || !all_valid(prune_candidates, false)
+            || !all_valid(front, false) || !all_valid(archive, false)) {
+        return "node id out of range";
+    }
+
+    // the front goes back into the spatial index, which must only hold
+    // nodes still in the tree
+    auto all_live = [&](const std::vector<node_id>& ids) {
+        return std::all_of(ids.begin(), ids.end(), [&](node_id n) { return node_live[n]; });
+    };
+
+    if (!all_live(front) || !all_live(archive)) {
+        return "pruned node in the front or archive";
+    }
+
+    std::size_t attractors = attractor_x.size();
+    if (attractor_y.size() != attractors || attractor_dormant.size() != attractors
+            || attractor_nearest_node.size() != attractors
+            || attractor_nearest_distance.size() != attractors
+            || attractor_nearest_seen.size() != attractors) {
+        return "attractor columns of different lengths";
+    }
+
+    if (!std::all_of(attractor_nearest_node.begin(), attractor_nearest_node.end(), valid)) {
+        return "node id out of range";
+    }
+
+    // the nodes from this one on are searched for a closer node
+    if (!std::all_of(attractor_nearest_seen.begin(), attractor_nearest_seen.end(),
+            [&](unsigned int seen) { return seen <= nodes; })) {
+        return "node count out of range";
+    }
+
+    if (p.mask_given && (mask_data.empty()
+            || mask_data.size() != std::size_t(p.mask_width) * p.mask_height)) {
+        return "mask of the wrong size";
+    }
+
+    return "";
+}
+
+template class growth::basic_checkpoint<growth::float_kernel>;
+template class growth::basic_checkpoint<growth::double_kernel>;
+template class growth::basic_checkpoint<growth::cgal_kernel>;
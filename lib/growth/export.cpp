@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "growth/export.hpp"
+
+using namespace growth;
+using namespace growth::exporters;
+
+namespace {
+
+    const char edge_magic[8] = { 'G', 'R', 'O', 'W', 'T', 'H', 'E', 'L' };
+
+    /**
+     * Buffers writes to a file descriptor, handing them on whenever the
+     * buffer fills.
+     */
+    class fd_writer {
+        public:
+
+            explicit fd_writer(int fd): fd_(fd) { buffer_.reserve(capacity); }
+
+            void write(const char* data, std::size_t size) {
+                if (buffer_.size() + size > capacity) {
+                    flush();
+                }
+                buffer_.insert(buffer_.end(), data, data + size);
+            }
+
+            void write(const char* text) { write(text, std::strlen(text)); }
+
+            /**
+             * Writes the number with at most two decimals, a hundredth of
+             * a pixel being finer than anything that will be drawn.
+             */
+            void number(double value) {
+                // as a whole number of hundredths, which is much faster to
+                // format than the double
+                long long hundredths = std::llround(value * 100.0);
+                char digits[32];
+                char* end = digits;
+
+                if (hundredths < 0) {
+                    *end++ = '-';
+                    hundredths = -hundredths;
+                }
+
+                end = std::to_chars(end, digits + sizeof(digits), hundredths / 100).ptr;
+
+                // the decimals without their trailing zeros
+                int decimals = hundredths % 100;
+                if (decimals != 0) {
+                    *end++ = '.';
+                    *end++ = '0' + decimals / 10;
+                    if (decimals % 10 != 0) {
+                        *end++ = '0' + decimals % 10;
+                    }
+                }
+
+                write(digits, end - digits);
+            }
+
+            /**
+             * Writes out everything buffered, retrying partial writes as a
+             * pipe may take less than asked at once.
+             */
+            void flush() {
+                const char* data = buffer_.data();
+                std::size_t left = buffer_.size();
+
+                while (left > 0) {
+                    ssize_t written = ::write(fd_, data, left);
+                    if (written < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+                        throw std::runtime_error(std::string("could not write the export: ")
+                            + std::strerror(errno));
+                    }
+
+                    data += written;
+                    left -= written;
+                }
+
+                buffer_.clear();
+            }
+
+        private:
+
+            static constexpr std::size_t capacity = 1 << 16;
+
+            int fd_;
+            std::vector<char> buffer_;
+
+    };
+
+    // a node waiting to be visited, its parent and the parent's number
+    struct visit {
+        node_id node;
+        node_id parent;
+        std::uint32_t parent_number;
+    };
+
+    /**
+     * Calls f with each node reachable from the seeds, its parent, and
+     * the parent's number in the walk, parents before their children. The
+     * seeds have no_node for both. Only the nodes waiting to be visited
+     * are held on to.
+     */
+    template <typename Kernel, typename F>
+    void walk(basic_venation<Kernel>& v, F&& f) {
+        auto& nodes = v.nodes();
+        std::vector<visit> to_visit;
+        std::uint32_t next = 0;
+
+        for (node_id seed = 0; seed < v.num_seeds(); ++seed) {
+            to_visit.push_back({ seed, no_node, no_node });
+
+            while (!to_visit.empty()) {
+                auto current = to_visit.back();
+                to_visit.pop_back();
+
+                std::uint32_t number = next++;
+                f(current.node, current.parent, current.parent_number);
+
+                for (auto child = nodes.first_child[current.node]; child != no_node;
+                        child = nodes.next_sibling[child]) {
+                    to_visit.push_back({ child, current.node, number });
+                }
+            }
+        }
+    }
+
+}
+
+template <typename Kernel>
+void exporters::write_svg(int fd, basic_venation<Kernel>& v) {
+    fd_writer out(fd);
+    auto& nodes = v.nodes();
+    double aspect_ratio = static_cast<double>(v.aspect_ratio());
+    double width = v.width();
+    double height = v.height();
+
+    out.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"");
+    out.number(width);
+    out.write("\" height=\"");
+    out.number(height);
+    out.write("\" viewBox=\"0 0 ");
+    out.number(width);
+    out.write(" ");
+    out.number(height);
+    out.write("\">\n<rect width=\"100%\" height=\"100%\" fill=\"black\"/>\n"
+        "<g stroke=\"white\" stroke-linecap=\"round\" fill=\"none\">\n");
+
+    // the same mapping to pixels as the image output
+    auto x = [&](node_id n) {
+        return (static_cast<double>(nodes.x[n]) / aspect_ratio * 0.5 + 0.5) * width;
+    };
+    auto y = [&](node_id n) {
+        return (0.5 - static_cast<double>(nodes.y[n]) * 0.5) * height;
+    };
+
+    // an edge to each node from its parent, as wide as the node
+    walk(v, [&](node_id n, node_id parent, std::uint32_t) {
+        if (parent == no_node) {
+            return;
+        }
+
+        out.write("<path d=\"M");
+        out.number(x(parent));
+        out.write(" ");
+        out.number(y(parent));
+        out.write("L");
+        out.number(x(n));
+        out.write(" ");
+        out.number(y(n));
+        out.write("\" stroke-width=\"");
+        out.number(std::max(static_cast<double>(nodes.width[n]) * 3.0, 1.0));
+        out.write("\"/>\n");
+    });
+
+    out.write("</g>\n</svg>\n");
+    out.flush();
+}
+
+template <typename Kernel>
+void exporters::write_edges(int fd, basic_venation<Kernel>& v) {
+    fd_writer out(fd);
+    auto& nodes = v.nodes();
+
+    edge_header header = {};
+    std::memcpy(header.magic, edge_magic, sizeof(edge_magic));
+    header.version = edge_version;
+    header.edge_size = sizeof(edge);
+    header.width = v.width();
+    header.height = v.height();
+    header.aspect_ratio = v.aspect_ratio();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    walk(v, [&](node_id n, node_id, std::uint32_t parent_number) {
+        edge e;
+        e.x = nodes.x[n];
+        e.y = nodes.y[n];
+        e.width = nodes.width[n];
+        e.parent = parent_number;
+        out.write(reinterpret_cast<const char*>(&e), sizeof(e));
+    });
+
+    out.flush();
+}
+
+template void growth::exporters::write_svg(int, basic_venation<float_kernel>&);
+template void growth::exporters::write_svg(int, basic_venation<double_kernel>&);
+template void growth::exporters::write_svg(int, basic_venation<cgal_kernel>&);
+template void growth::exporters::write_edges(int, basic_venation<float_kernel>&);
+template void growth::exporters::write_edges(int, basic_venation<double_kernel>&);
+template void growth::exporters::write_edges(int, basic_venation<cgal_kernel>&);
@@ -1,64 +1,173 @@
 #include <cmath>
 
 #include "growth/node.hpp"
+#include "growth/trace.hpp"
 #include "util.hpp"
 
-std::vector<growth::node_ref> growth::node::optimize() {
-    std::vector<growth::node_ref> removed;
+using namespace growth;
 
-    if (children.size() == 0) {
-        // if there are no children no optimization needed
-        return removed;
+template <typename Kernel>
+node_id basic_node_arena<Kernel>::create(const point2& p, const vector2& d,
+        node_id parent_id) {
+    node_id n = x.size();
+
+    x.push_back(p.x());
+    y.push_back(p.y());
+    dx.push_back(d.x());
+    dy.push_back(d.y());
+    width.push_back(base_width_);
+    parent.push_back(parent_id);
+    first_child.push_back(no_node);
+    next_sibling.push_back(no_node);
+    live.push_back(1);
+    last_child_.push_back(no_node);
+
+    if (parent_id != no_node) {
+        // append to the parent's children
+        if (first_child[parent_id] == no_node) {
+            first_child[parent_id] = n;
+        } else {
+            next_sibling[last_child_[parent_id]] = n;
+        }
+
+        last_child_[parent_id] = n;
+        update_width(parent_id);
     }
 
+    return n;
+}
+
+template <typename Kernel>
+std::vector<node_id> basic_node_arena<Kernel>::optimize(node_id n) {
+    std::vector<node_id> removed;
+
     // for each child, remove any nodes with a single child
-    for (int i = 0; i < children.size(); ++i) {
-        auto& child = children[i];
-        auto direction = util::normalize(child->position - position);
-        auto& current = child;
-
-        // step through the children as long as it is a straight line.
-        while (current->children.size() == 1) {
-            auto& next = current->children[0];
-            auto next_direction = util::normalize(next->position - position);
-
-            if (next_direction != direction) {
-                break;
-            }
+    for (node_id child = first_child[n]; child != no_node; child = next_sibling[child]) {
+        std::size_t before = removed.size();
+        optimize(n, child, removed);
 
-            removed.push_back(current);
-            current = next;
+        // continue from whichever node took the child's place
+        if (removed.size() != before) {
+            child = first_child[removed.back()];
         }
-
-        children[i] = current;
     }
 
     return removed;
 }
 
+template <typename Kernel>
+void basic_node_arena<Kernel>::optimize(node_id n, node_id child,
+        std::vector<node_id>& removed) {
+    auto origin = position(n);
+    auto direction = util::normalize(position(child) - origin);
+    node_id current = child;
+
+    // step through the children as long as it is a straight line.
+    while (first_child[current] != no_node
+            && next_sibling[first_child[current]] == no_node) {
+        node_id next = first_child[current];
+        auto next_direction = util::normalize(position(next) - origin);
+
+        if (next_direction != direction) {
+            break;
+        }
+
+        removed.push_back(current);
+        live[current] = 0;
+        current = next;
+    }
+
+    if (current == child) {
+        return;
+    }
+
+    // splice the end of the straight line in place of the child
+    node_id previous = no_node;
+    for (node_id c = first_child[n]; c != child; c = next_sibling[c]) {
+        previous = c;
+    }
+
+    next_sibling[current] = next_sibling[child];
+    parent[current] = n;
+
+    if (previous == no_node) {
+        first_child[n] = current;
+    } else {
+        next_sibling[previous] = current;
+    }
+
+    if (last_child_[n] == child) {
+        last_child_[n] = current;
+    }
+}
+
 /**
- * Update width by traversing the tree and computing the width
- * of each node's children.
+ * Update width by walking up from the node. Every node's children are
+ * up to date, so only the node's own width needs to be recomputed at each
+ * level, and once one is unchanged none above it can change either.
  */
-double growth::node::update_width() {
-    if (children.size() == 0) {
-        // if no children we are a leaf
-        width = base_width;
-    } else if (children.size() == 1) {
-        // if only one child we just inherit its width
-        width = children[0]->update_width();
-    } else {
-        // recursively sum the children's widths
-        double sum = 0.0;
-        for (const auto& child : children) {
-            sum += std::pow(child->update_width(), 3.0);
+template <typename Kernel>
+void basic_node_arena<Kernel>::update_width(node_id n) {
+    GROWTH_TRACE_SCOPE(update_width);
+
+    while (n != no_node) {
+        node_id child = first_child[n];
+        scalar w;
+
+        if (child == no_node) {
+            // if no children we are a leaf
+            w = base_width_;
+        } else if (next_sibling[child] == no_node) {
+            // if only one child we just inherit its width
+            w = width[child];
+        } else {
+            // sum the children's widths
+            scalar sum = 0.0;
+            for (; child != no_node; child = next_sibling[child]) {
+                sum += std::pow(width[child], (scalar)3.0);
+            }
+            w = std::cbrt(sum);
         }
-        width = std::cbrt(sum);
+
+        if (w == width[n]) {
+            return;
+        }
+
+        width[n] = w;
+        n = parent[n];
     }
+}
 
-    return width;
+template <typename Kernel>
+void basic_node_arena<Kernel>::clear() {
+    x.clear();
+    y.clear();
+    dx.clear();
+    dy.clear();
+    width.clear();
+    parent.clear();
+    first_child.clear();
+    next_sibling.clear();
+    live.clear();
+    last_child_.clear();
 }
 
-growth::node_ref growth::node::create(const growth::node::point2& p, const growth::node::vector2& d) {
-    return std::make_shared<growth::node>(p, d);
+template <typename Kernel>
+void basic_node_arena<Kernel>::relink() {
+    last_child_.assign(x.size(), no_node);
+
+    // optimized out nodes are never linked to again
+    for (node_id n = 0; n < x.size(); ++n) {
+        if (!live[n]) {
+            continue;
+        }
+
+        for (node_id c = first_child[n]; c != no_node; c = next_sibling[c]) {
+            last_child_[n] = c;
+        }
+    }
 }
+
+template class growth::basic_node_arena<growth::float_kernel>;
+template class growth::basic_node_arena<growth::double_kernel>;
+template class growth::basic_node_arena<growth::cgal_kernel>;
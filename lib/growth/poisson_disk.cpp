@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "growth/poisson_disk.hpp"
+#include "growth/rng.hpp"
+
+using namespace growth;
+
+namespace {
+
+    /**
+     * Points per area at a density of 1, in units of the squared radius.
+     * Dart throwing can at most reach the jamming limit of random disk
+     * packing, where disks of half the radius cover about 55% of the
+     * plane. The default rounds get to about 89% of it, as later rounds
+     * add fewer and fewer points.
+     */
+    constexpr double fill = 0.89 * 0.547 * 4.0 / 3.14159265358979323846;
+
+    // a cell's point, empty while its radius is 0
+    struct cell {
+        float x = 0.0f;
+        float y = 0.0f;
+        float radius = 0.0f;
+    };
+
+    // a cell relative to another, and how close their points can be
+    struct offset {
+        int column;
+        int row;
+        double distance;
+    };
+
+}
+
+poisson_disk::poisson_disk(double min_x, double min_y, double max_x, double max_y):
+    min_x_(min_x), min_y_(min_y), max_x_(max_x), max_y_(max_y) {}
+
+poisson_disk& poisson_disk::density(const std::vector<float>& weights,
+        unsigned int width, unsigned int height) {
+    weights_ = weights;
+    weights_width_ = width;
+    weights_height_ = height;
+    return *this;
+}
+
+/**
+ * The density at the point, from the pixel of the image it falls in.
+ */
+float poisson_disk::weight(double x, double y) const {
+    if (weights_.empty()) {
+        return 1.0f;
+    }
+
+    int column = (x - min_x_) / (max_x_ - min_x_) * weights_width_;
+    int row = (max_y_ - y) / (max_y_ - min_y_) * weights_height_;
+    column = std::clamp(column, 0, int(weights_width_) - 1);
+    row = std::clamp(row, 0, int(weights_height_) - 1);
+    return weights_[row * weights_width_ + column];
+}
+
+std::vector<std::pair<float, float>> poisson_disk::generate(std::size_t count,
+        thread_pool& pool, std::uint64_t seed, std::uint64_t stream) const {
+    double width = max_x_ - min_x_;
+    double height = max_y_ - min_y_;
+
+    // the integral of the density, and its smallest and largest
+    // positive values which bound the radius
+    double total = width * height;
+    float lightest = 1.0f;
+    float darkest = 1.0f;
+
+    if (!weights_.empty()) {
+        total = 0.0;
+        lightest = 0.0f;
+        darkest = std::numeric_limits<float>::infinity();
+        for (const auto w : weights_) {
+            if (w > 0.0f) {
+                total += w;
+                lightest = std::max(lightest, w);
+                darkest = std::min(darkest, w);
+            }
+        }
+
+        total *= width * height / weights_.size();
+    }
+
+    if (count == 0 || !(total > 0.0)) {
+        return {};
+    }
+
+    // the radius at a density of 1 which fits count points
+    double radius = std::sqrt(fill * total / count);
+    double min_radius = radius / std::sqrt(lightest);
+    double max_radius = radius / std::sqrt(darkest);
+
+    // a cell's diagonal is the smallest radius, so it holds one point
+    // at most, and a tile spans the largest
+    double size = min_radius / std::sqrt(2.0);
+    std::size_t columns = std::max(1.0, std::ceil(width / size));
+    std::size_t rows = std::max(1.0, std::ceil(height / size));
+    std::size_t tile = std::ceil(max_radius / size);
+    std::size_t tile_columns = (columns + tile - 1) / tile;
+    std::size_t tile_rows = (rows + tile - 1) / tile;
+
+    std::vector<cell> cells(columns * rows);
+
+    // the cells around a dart that may hold a point within the largest
+    // radius, closest first as they are the likeliest to conflict
+    std::vector<offset> offsets;
+    int span = tile;
+    for (int j = -span; j <= span; ++j) {
+        for (int i = -span; i <= span; ++i) {
+            double dx = std::max(std::abs(i) - 1, 0) * size;
+            double dy = std::max(std::abs(j) - 1, 0) * size;
+            offsets.push_back({i, j, std::sqrt(dx * dx + dy * dy)});
+        }
+    }
+
+    std::sort(offsets.begin(), offsets.end(), [](const offset& a, const offset& b) {
+        return a.distance < b.distance;
+    });
+
+    auto throw_dart = [&](std::size_t column, std::size_t row, std::uint64_t round) {
+        auto& c = cells[row * columns + column];
+        if (c.radius > 0.0f) {
+            return;
+        }
+
+        std::uint64_t counter = 2 * (round * cells.size() + row * columns + column);
+        double x = min_x_ + (column + rng::uniform(seed, stream, counter)) * size;
+        double y = min_y_ + (row + rng::uniform(seed, stream, counter + 1)) * size;
+        if (x >= max_x_ || y >= max_y_) {
+            return;
+        }
+
+        float w = weight(x, y);
+        if (!(w > 0.0f)) {
+            return;
+        }
+
+        // two points conflict when closer than the smaller of their
+        // radii, so only this dart's radius needs to be searched
+        double r = radius / std::sqrt(w);
+        for (const auto& o : offsets) {
+            if (o.distance >= r) {
+                break;
+            }
+
+            std::size_t i = column + o.column;
+            std::size_t j = row + o.row;
+            if (i >= columns || j >= rows) {
+                continue;
+            }
+
+            const auto& other = cells[j * columns + i];
+            if (other.radius == 0.0f) {
+                continue;
+            }
+
+            double dx = other.x - x;
+            double dy = other.y - y;
+            double limit = std::min<double>(r, other.radius);
+            if (dx * dx + dy * dy < limit * limit) {
+                return;
+            }
+        }
+
+        c.x = x;
+        c.y = y;
+        c.radius = r;
+    };
+
+    for (unsigned int round = 0; round < rounds_; ++round) {
+        for (std::size_t color = 0; color < 4; ++color) {
+            std::size_t first_tile_column = color % 2;
+            std::size_t first_tile_row = color / 2;
+            std::size_t per_row = (tile_columns - first_tile_column + 1) / 2;
+            std::size_t num_rows = (tile_rows - first_tile_row + 1) / 2;
+
+            pool.parallel_for(per_row * num_rows, [&](std::size_t t) {
+                std::size_t tile_column = first_tile_column + 2 * (t % per_row);
+                std::size_t tile_row = first_tile_row + 2 * (t / per_row);
+                std::size_t end_column = std::min(columns, (tile_column + 1) * tile);
+                std::size_t end_row = std::min(rows, (tile_row + 1) * tile);
+
+                for (std::size_t j = tile_row * tile; j < end_row; ++j) {
+                    for (std::size_t i = tile_column * tile; i < end_column; ++i) {
+                        throw_dart(i, j, round);
+                    }
+                }
+            });
+        }
+    }
+
+    std::vector<std::pair<float, float>> points;
+    points.reserve(count);
+    for (const auto& c : cells) {
+        if (c.radius > 0.0f) {
+            points.emplace_back(c.x, c.y);
+        }
+    }
+
+    return points;
+}
@@ -0,0 +1,563 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GROWTH_SIMD_X86
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define GROWTH_SIMD_NEON
+#endif
+
+#include "growth/simd.hpp"
+
+using namespace growth;
+
+namespace {
+
+    /*
+     * Scalar fallback, also used for the tails of the vector paths.
+     */
+
+    template <typename T>
+    void squared_distances_scalar(const T* xs, const T* ys, std::size_t n,
+            T px, T py, T* out) {
+        for (std::size_t i = 0; i < n; ++i) {
+            T dx = xs[i] - px;
+            T dy = ys[i] - py;
+            out[i] = dx * dx + dy * dy;
+        }
+    }
+
+    template <typename T>
+    std::size_t nearest_scalar(const T* xs, const T* ys, const std::uint8_t* live,
+            std::size_t n, T px, T py, T& distance2) {
+        std::size_t best = n;
+        T best_distance = std::numeric_limits<T>::infinity();
+
+        for (std::size_t i = 0; i < n; ++i) {
+            if (live && !live[i]) {
+                continue;
+            }
+
+            T dx = xs[i] - px;
+            T dy = ys[i] - py;
+            T d = dx * dx + dy * dy;
+            if (d < best_distance) {
+                best_distance = d;
+                best = i;
+            }
+        }
+
+        distance2 = best_distance;
+        return best;
+    }
+
+    template <typename T>
+    void directions_scalar(const T* ax, const T* ay, const T* bx, const T* by,
+            std::size_t n, T min_weight, T* dx, T* dy) {
+        for (std::size_t i = 0; i < n; ++i) {
+            T ex = ax[i] - bx[i];
+            T ey = ay[i] - by[i];
+            T length = std::sqrt(ex * ex + ey * ey);
+            T weight = std::max(min_weight, length);
+            dx[i] = ex / length / weight;
+            dy[i] = ey / length / weight;
+        }
+    }
+
+    /**
+     * Combines the per lane results of a vector nearest search with the
+     * search of the remaining points, keeping the first index on ties.
+     */
+    template <typename T, typename I>
+    std::size_t reduce_nearest(const T* lane_distance, const I* lane_index,
+            int lanes, std::size_t tail_index, T tail_distance, T& distance2) {
+        std::size_t best = tail_index;
+        T best_distance = tail_distance;
+
+        for (int l = 0; l < lanes; ++l) {
+            if (lane_distance[l] < best_distance
+                    || (lane_distance[l] == best_distance
+                        && best_distance != std::numeric_limits<T>::infinity()
+                        && (std::size_t)lane_index[l] < best)) {
+                best_distance = lane_distance[l];
+                best = lane_index[l];
+            }
+        }
+
+        distance2 = best_distance;
+        return best;
+    }
+
+#ifdef GROWTH_SIMD_X86
+
+    /*
+     * AVX2, 8 doubles or 8 floats at a time. The double kernels work on
+     * two vectors per iteration with independent accumulators, so their
+     * latency overlaps, then on one for the remaining group of 4. This
+     * pays off in nearest, whose compare and blend chain is otherwise
+     * serial; distances is bound by loads and stores and directions by
+     * the divider, so for them it is only kept for uniformity. FMA is
+     * deliberately not enabled so the results match the scalar path.
+     */
+
+    __attribute__((target("avx2")))
+    void squared_distances_avx2(const double* xs, const double* ys, std::size_t n,
+            double px, double py, double* out) {
+        __m256d vpx = _mm256_set1_pd(px);
+        __m256d vpy = _mm256_set1_pd(py);
+        std::size_t i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            __m256d dx0 = _mm256_sub_pd(_mm256_loadu_pd(xs + i), vpx);
+            __m256d dy0 = _mm256_sub_pd(_mm256_loadu_pd(ys + i), vpy);
+            __m256d dx1 = _mm256_sub_pd(_mm256_loadu_pd(xs + i + 4), vpx);
+            __m256d dy1 = _mm256_sub_pd(_mm256_loadu_pd(ys + i + 4), vpy);
+            _mm256_storeu_pd(out + i,
+                _mm256_add_pd(_mm256_mul_pd(dx0, dx0), _mm256_mul_pd(dy0, dy0)));
+            _mm256_storeu_pd(out + i + 4,
+                _mm256_add_pd(_mm256_mul_pd(dx1, dx1), _mm256_mul_pd(dy1, dy1)));
+        }
+
+        for (; i + 4 <= n; i += 4) {
+            __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), vpx);
+            __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), vpy);
+            _mm256_storeu_pd(out + i,
+                _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)));
+        }
+
+        squared_distances_scalar(xs + i, ys + i, n - i, px, py, out + i);
+    }
+
+    __attribute__((target("avx2")))
+    void squared_distances_avx2(const float* xs, const float* ys, std::size_t n,
+            float px, float py, float* out) {
+        __m256 vpx = _mm256_set1_ps(px);
+        __m256 vpy = _mm256_set1_ps(py);
+        std::size_t i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), vpx);
+            __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), vpy);
+            _mm256_storeu_ps(out + i,
+                _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+        }
+
+        squared_distances_scalar(xs + i, ys + i, n - i, px, py, out + i);
+    }
+
+    /**
+     * Keeps each of the 4 points from i closer than best's lane, unless
+     * dead, in best and its index in best_index, then steps index on.
+     */
+    __attribute__((target("avx2")))
+    inline void nearest_group_avx2(const double* xs, const double* ys,
+            const std::uint8_t* live, std::size_t i, __m256d vpx, __m256d vpy,
+            __m256d step, __m256d& best, __m256d& best_index, __m256d& index) {
+        __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(xs + i), vpx);
+        __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(ys + i), vpy);
+        __m256d d = _mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy));
+
+        if (live) {
+            std::int32_t flags;
+            std::memcpy(&flags, live + i, sizeof(flags));
+            __m256i wide = _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(flags));
+            __m256d dead = _mm256_castsi256_pd(
+                _mm256_cmpeq_epi64(wide, _mm256_setzero_si256()));
+            d = _mm256_blendv_pd(d,
+                _mm256_set1_pd(std::numeric_limits<double>::infinity()), dead);
+        }
+
+        __m256d closer = _mm256_cmp_pd(d, best, _CMP_LT_OQ);
+        best = _mm256_blendv_pd(best, d, closer);
+        best_index = _mm256_blendv_pd(best_index, index, closer);
+        index = _mm256_add_pd(index, step);
+    }
+
+    __attribute__((target("avx2")))
+    std::size_t nearest_avx2(const double* xs, const double* ys,
+            const std::uint8_t* live, std::size_t n, double px, double py,
+            double& distance2) {
+        __m256d vpx = _mm256_set1_pd(px);
+        __m256d vpy = _mm256_set1_pd(py);
+        __m256d infinity = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+        // indices are kept as doubles, exact far beyond any node count
+        __m256d best[2] = { infinity, infinity };
+        __m256d best_index[2] = { _mm256_setzero_pd(), _mm256_setzero_pd() };
+        __m256d index[2] = { _mm256_setr_pd(0.0, 1.0, 2.0, 3.0),
+            _mm256_setr_pd(4.0, 5.0, 6.0, 7.0) };
+        __m256d step = _mm256_set1_pd(8.0);
+        std::size_t i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            nearest_group_avx2(xs, ys, live, i, vpx, vpy, step, best[0],
+                best_index[0], index[0]);
+            nearest_group_avx2(xs, ys, live, i + 4, vpx, vpy, step, best[1],
+                best_index[1], index[1]);
+        }
+
+        if (i + 4 <= n) {
+            nearest_group_avx2(xs, ys, live, i, vpx, vpy, step, best[0],
+                best_index[0], index[0]);
+            i += 4;
+        }
+
+        double tail_distance;
+        std::size_t tail = nearest_scalar(xs + i, ys + i, live ? live + i : nullptr,
+            n - i, px, py, tail_distance);
+        tail = tail == n - i ? n : tail + i;
+
+        alignas(32) double lane_distance[8];
+        alignas(32) double lane_index[8];
+        _mm256_store_pd(lane_distance, best[0]);
+        _mm256_store_pd(lane_distance + 4, best[1]);
+        _mm256_store_pd(lane_index, best_index[0]);
+        _mm256_store_pd(lane_index + 4, best_index[1]);
+
+        return reduce_nearest(lane_distance, lane_index, 8, tail, tail_distance,
+            distance2);
+    }
+
+    __attribute__((target("avx2")))
+    std::size_t nearest_avx2(const float* xs, const float* ys,
+            const std::uint8_t* live, std::size_t n, float px, float py,
+            float& distance2) {
+        __m256 vpx = _mm256_set1_ps(px);
+        __m256 vpy = _mm256_set1_ps(py);
+        __m256 infinity = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+        __m256 best = infinity;
+        __m256i best_index = _mm256_setzero_si256();
+        __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256i step = _mm256_set1_epi32(8);
+        std::size_t i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(xs + i), vpx);
+            __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(ys + i), vpy);
+            __m256 d = _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy));
+
+            if (live) {
+                __m256i wide = _mm256_cvtepu8_epi32(
+                    _mm_loadl_epi64((const __m128i*)(live + i)));
+                __m256 dead = _mm256_castsi256_ps(
+                    _mm256_cmpeq_epi32(wide, _mm256_setzero_si256()));
+                d = _mm256_blendv_ps(d, infinity, dead);
+            }
+
+            __m256 closer = _mm256_cmp_ps(d, best, _CMP_LT_OQ);
+            best = _mm256_blendv_ps(best, d, closer);
+            best_index = _mm256_castps_si256(_mm256_blendv_ps(
+                _mm256_castsi256_ps(best_index), _mm256_castsi256_ps(index), closer));
+            index = _mm256_add_epi32(index, step);
+        }
+
+        float tail_distance;
+        std::size_t tail = nearest_scalar(xs + i, ys + i, live ? live + i : nullptr,
+            n - i, px, py, tail_distance);
+        tail = tail == n - i ? n : tail + i;
+
+        alignas(32) float lane_distance[8];
+        alignas(32) std::uint32_t lane_index[8];
+        _mm256_store_ps(lane_distance, best);
+        _mm256_store_si256((__m256i*)lane_index, best_index);
+
+        return reduce_nearest(lane_distance, lane_index, 8, tail, tail_distance,
+            distance2);
+    }
+
+    /**
+     * The directions of the 4 pairs from i.
+     */
+    __attribute__((target("avx2")))
+    inline void directions_group_avx2(const double* ax, const double* ay,
+            const double* bx, const double* by, std::size_t i, __m256d vmin_weight,
+            double* dx, double* dy) {
+        __m256d ex = _mm256_sub_pd(_mm256_loadu_pd(ax + i), _mm256_loadu_pd(bx + i));
+        __m256d ey = _mm256_sub_pd(_mm256_loadu_pd(ay + i), _mm256_loadu_pd(by + i));
+        __m256d length = _mm256_sqrt_pd(
+            _mm256_add_pd(_mm256_mul_pd(ex, ex), _mm256_mul_pd(ey, ey)));
+        __m256d weight = _mm256_max_pd(length, vmin_weight);
+        _mm256_storeu_pd(dx + i, _mm256_div_pd(_mm256_div_pd(ex, length), weight));
+        _mm256_storeu_pd(dy + i, _mm256_div_pd(_mm256_div_pd(ey, length), weight));
+    }
+
+    __attribute__((target("avx2")))
+    void directions_avx2(const double* ax, const double* ay, const double* bx,
+            const double* by, std::size_t n, double min_weight, double* dx,
+            double* dy) {
+        __m256d vmin_weight = _mm256_set1_pd(min_weight);
+        std::size_t i = 0;
+
+        // two independent groups per iteration to overlap the square
+        // roots' and divisions' latency
+        for (; i + 8 <= n; i += 8) {
+            directions_group_avx2(ax, ay, bx, by, i, vmin_weight, dx, dy);
+            directions_group_avx2(ax, ay, bx, by, i + 4, vmin_weight, dx, dy);
+        }
+
+        if (i + 4 <= n) {
+            directions_group_avx2(ax, ay, bx, by, i, vmin_weight, dx, dy);
+            i += 4;
+        }
+
+        directions_scalar(ax + i, ay + i, bx + i, by + i, n - i, min_weight,
+            dx + i, dy + i);
+    }
+
+    __attribute__((target("avx2")))
+    void directions_avx2(const float* ax, const float* ay, const float* bx,
+            const float* by, std::size_t n, float min_weight, float* dx,
+            float* dy) {
+        __m256 vmin_weight = _mm256_set1_ps(min_weight);
+        std::size_t i = 0;
+
+        for (; i + 8 <= n; i += 8) {
+            __m256 ex = _mm256_sub_ps(_mm256_loadu_ps(ax + i), _mm256_loadu_ps(bx + i));
+            __m256 ey = _mm256_sub_ps(_mm256_loadu_ps(ay + i), _mm256_loadu_ps(by + i));
+            __m256 length = _mm256_sqrt_ps(
+                _mm256_add_ps(_mm256_mul_ps(ex, ex), _mm256_mul_ps(ey, ey)));
+            __m256 weight = _mm256_max_ps(length, vmin_weight);
+            _mm256_storeu_ps(dx + i, _mm256_div_ps(_mm256_div_ps(ex, length), weight));
+            _mm256_storeu_ps(dy + i, _mm256_div_ps(_mm256_div_ps(ey, length), weight));
+        }
+
+        directions_scalar(ax + i, ay + i, bx + i, by + i, n - i, min_weight,
+            dx + i, dy + i);
+    }
+
+#endif
+
+#ifdef GROWTH_SIMD_NEON
+
+    /*
+     * NEON, 2 doubles or 4 floats at a time. Always available on AArch64.
+     */
+
+    void squared_distances_neon(const double* xs, const double* ys, std::size_t n,
+            double px, double py, double* out) {
+        float64x2_t vpx = vdupq_n_f64(px);
+        float64x2_t vpy = vdupq_n_f64(py);
+        std::size_t i = 0;
+
+        for (; i + 2 <= n; i += 2) {
+            float64x2_t dx = vsubq_f64(vld1q_f64(xs + i), vpx);
+            float64x2_t dy = vsubq_f64(vld1q_f64(ys + i), vpy);
+            vst1q_f64(out + i, vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy)));
+        }
+
+        squared_distances_scalar(xs + i, ys + i, n - i, px, py, out + i);
+    }
+
+    void squared_distances_neon(const float* xs, const float* ys, std::size_t n,
+            float px, float py, float* out) {
+        float32x4_t vpx = vdupq_n_f32(px);
+        float32x4_t vpy = vdupq_n_f32(py);
+        std::size_t i = 0;
+
+        for (; i + 4 <= n; i += 4) {
+            float32x4_t dx = vsubq_f32(vld1q_f32(xs + i), vpx);
+            float32x4_t dy = vsubq_f32(vld1q_f32(ys + i), vpy);
+            vst1q_f32(out + i, vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy)));
+        }
+
+        squared_distances_scalar(xs + i, ys + i, n - i, px, py, out + i);
+    }
+
+    std::size_t nearest_neon(const double* xs, const double* ys,
+            const std::uint8_t* live, std::size_t n, double px, double py,
+            double& distance2) {
+        float64x2_t vpx = vdupq_n_f64(px);
+        float64x2_t vpy = vdupq_n_f64(py);
+        float64x2_t infinity = vdupq_n_f64(std::numeric_limits<double>::infinity());
+        float64x2_t best = infinity;
+        uint64x2_t best_index = vdupq_n_u64(0);
+        uint64x2_t index = { 0, 1 };
+        uint64x2_t step = vdupq_n_u64(2);
+        std::size_t i = 0;
+
+        for (; i + 2 <= n; i += 2) {
+            float64x2_t dx = vsubq_f64(vld1q_f64(xs + i), vpx);
+            float64x2_t dy = vsubq_f64(vld1q_f64(ys + i), vpy);
+            float64x2_t d = vaddq_f64(vmulq_f64(dx, dx), vmulq_f64(dy, dy));
+
+            if (live) {
+                uint64x2_t flags = { live[i], live[i + 1] };
+                d = vbslq_f64(vceqq_u64(flags, vdupq_n_u64(0)), infinity, d);
+            }
+
+            uint64x2_t closer = vcltq_f64(d, best);
+            best = vbslq_f64(closer, d, best);
+            best_index = vbslq_u64(closer, index, best_index);
+            index = vaddq_u64(index, step);
+        }
+
+        double tail_distance;
+        std::size_t tail = nearest_scalar(xs + i, ys + i, live ? live + i : nullptr,
+            n - i, px, py, tail_distance);
+        tail = tail == n - i ? n : tail + i;
+
+        double lane_distance[2];
+        std::uint64_t lane_index[2];
+        vst1q_f64(lane_distance, best);
+        vst1q_u64(lane_index, best_index);
+
+        return reduce_nearest(lane_distance, lane_index, 2, tail, tail_distance,
+            distance2);
+    }
+
+    std::size_t nearest_neon(const float* xs, const float* ys,
+            const std::uint8_t* live, std::size_t n, float px, float py,
+            float& distance2) {
+        float32x4_t vpx = vdupq_n_f32(px);
+        float32x4_t vpy = vdupq_n_f32(py);
+        float32x4_t infinity = vdupq_n_f32(std::numeric_limits<float>::infinity());
+        float32x4_t best = infinity;
+        uint32x4_t best_index = vdupq_n_u32(0);
+        uint32x4_t index = { 0, 1, 2, 3 };
+        uint32x4_t step = vdupq_n_u32(4);
+        std::size_t i = 0;
+
+        for (; i + 4 <= n; i += 4) {
+            float32x4_t dx = vsubq_f32(vld1q_f32(xs + i), vpx);
+            float32x4_t dy = vsubq_f32(vld1q_f32(ys + i), vpy);
+            float32x4_t d = vaddq_f32(vmulq_f32(dx, dx), vmulq_f32(dy, dy));
+
+            if (live) {
+                uint32x4_t flags = { live[i], live[i + 1], live[i + 2], live[i + 3] };
+                d = vbslq_f32(vceqq_u32(flags, vdupq_n_u32(0)), infinity, d);
+            }
+
+            uint32x4_t closer = vcltq_f32(d, best);
+            best = vbslq_f32(closer, d, best);
+            best_index = vbslq_u32(closer, index, best_index);
+            index = vaddq_u32(index, step);
+        }
+
+        float tail_distance;
+        std::size_t tail = nearest_scalar(xs + i, ys + i, live ? live + i : nullptr,
+            n - i, px, py, tail_distance);
+        tail = tail == n - i ? n : tail + i;
+
+        float lane_distance[4];
+        std::uint32_t lane_index[4];
+        vst1q_f32(lane_distance, best);
+        vst1q_u32(lane_index, best_index);
+
+        return reduce_nearest(lane_distance, lane_index, 4, tail, tail_distance,
+            distance2);
+    }
+
+    void directions_neon(const double* ax, const double* ay, const double* bx,
+            const double* by, std::size_t n, double min_weight, double* dx,
+            double* dy) {
+        float64x2_t vmin_weight = vdupq_n_f64(min_weight);
+        std::size_t i = 0;
+
+        for (; i + 2 <= n; i += 2) {
+            float64x2_t ex = vsubq_f64(vld1q_f64(ax + i), vld1q_f64(bx + i));
+            float64x2_t ey = vsubq_f64(vld1q_f64(ay + i), vld1q_f64(by + i));
+            float64x2_t length = vsqrtq_f64(vaddq_f64(vmulq_f64(ex, ex), vmulq_f64(ey, ey)));
+            float64x2_t weight = vmaxq_f64(length, vmin_weight);
+            vst1q_f64(dx + i, vdivq_f64(vdivq_f64(ex, length), weight));
+            vst1q_f64(dy + i, vdivq_f64(vdivq_f64(ey, length), weight));
+        }
+
+        directions_scalar(ax + i, ay + i, bx + i, by + i, n - i, min_weight,
+            dx + i, dy + i);
+    }
+
+    void directions_neon(const float* ax, const float* ay, const float* bx,
+            const float* by, std::size_t n, float min_weight, float* dx,
+            float* dy) {
+        float32x4_t vmin_weight = vdupq_n_f32(min_weight);
+        std::size_t i = 0;
+
+        for (; i + 4 <= n; i += 4) {
+            float32x4_t ex = vsubq_f32(vld1q_f32(ax + i), vld1q_f32(bx + i));
+            float32x4_t ey = vsubq_f32(vld1q_f32(ay + i), vld1q_f32(by + i));
+            float32x4_t length = vsqrtq_f32(vaddq_f32(vmulq_f32(ex, ex), vmulq_f32(ey, ey)));
+            float32x4_t weight = vmaxq_f32(length, vmin_weight);
+            vst1q_f32(dx + i, vdivq_f32(vdivq_f32(ex, length), weight));
+            vst1q_f32(dy + i, vdivq_f32(vdivq_f32(ey, length), weight));
+        }
+
+        directions_scalar(ax + i, ay + i, bx + i, by + i, n - i, min_weight,
+            dx + i, dy + i);
+    }
+
+#endif
+
+    /**
+     * The implementations the kernels dispatch to for one scalar type.
+     */
+    template <typename T>
+    struct kernel_table {
+        void (*squared_distances)(const T*, const T*, std::size_t, T, T, T*);
+        std::size_t (*nearest)(const T*, const T*, const std::uint8_t*,
+            std::size_t, T, T, T&);
+        void (*directions)(const T*, const T*, const T*, const T*,
+            std::size_t, T, T*, T*);
+        const char* isa;
+    };
+
+    template <typename T>
+    kernel_table<T> select_kernels() {
+#if defined(GROWTH_SIMD_X86)
+        if (__builtin_cpu_supports("avx2")) {
+            return { squared_distances_avx2, nearest_avx2, directions_avx2, "avx2" };
+        }
+#elif defined(GROWTH_SIMD_NEON)
+        return { squared_distances_neon, nearest_neon, directions_neon, "neon" };
+#endif
+        return { squared_distances_scalar<T>, nearest_scalar<T>,
+            directions_scalar<T>, "scalar" };
+    }
+
+    /**
+     * Returns the kernels for T, selecting them on first use.
+     */
+    template <typename T>
+    const kernel_table<T>& kernels() {
+        static const kernel_table<T> table = select_kernels<T>();
+        return table;
+    }
+
+}
+
+template <typename T>
+void simd::squared_distances(const T* xs, const T* ys, std::size_t n,
+        T px, T py, T* out) {
+    kernels<T>().squared_distances(xs, ys, n, px, py, out);
+}
+
+template <typename T>
+std::size_t simd::nearest(const T* xs, const T* ys, const std::uint8_t* live,
+        std::size_t n, T px, T py, T& distance2) {
+    return kernels<T>().nearest(xs, ys, live, n, px, py, distance2);
+}
+
+template <typename T>
+void simd::directions(const T* ax, const T* ay, const T* bx, const T* by,
+        std::size_t n, T min_weight, T* dx, T* dy) {
+    kernels<T>().directions(ax, ay, bx, by, n, min_weight, dx, dy);
+}
+
+const char* simd::isa() {
+    return kernels<double>().isa;
+}
+
+template void simd::squared_distances<float>(const float*, const float*,
+    std::size_t, float, float, float*);
+template void simd::squared_distances<double>(const double*, const double*,
+    std::size_t, double, double, double*);
+template std::size_t simd::nearest<float>(const float*, const float*,
+    const std::uint8_t*, std::size_t, float, float, float&);
+template std::size_t simd::nearest<double>(const double*, const double*,
+    const std::uint8_t*, std::size_t, double, double, double&);
+template void simd::directions<float>(const float*, const float*, const float*,
+    const float*, std::size_t, float, float*, float*);
+template void simd::directions<double>(const double*, const double*,
+    const double*, const double*, std::size_t, double, double*, double*);
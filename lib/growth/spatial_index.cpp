@@ -0,0 +1,412 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+#include "growth/simd.hpp"
+#include "growth/spatial_index.hpp"
+
+using namespace growth;
+
+template <typename Kernel>
+void delaunay_index<Kernel>::insert(const std::vector<entry>& points) {
+    vertex_handle hint;
+
+    // insert one at a time to keep each vertex's handle, starting the
+    // point location from the previous point which is usually close by
+    for (const auto& p : points) {
+        auto before = graph_.number_of_vertices();
+        auto vertex = hint == vertex_handle()
+            ? graph_.insert(convert(p.first))
+            : graph_.insert(convert(p.first), hint->face());
+        hint = vertex;
+
+        // a point equal to an existing vertex is merged into it,
+        // the vertex stays with the id it was first inserted with
+        if (graph_.number_of_vertices() == before) {
+            continue;
+        }
+
+        vertex->info() = p.second;
+
+        if (p.second >= handles_.size()) {
+            handles_.resize(p.second + 1);
+        }
+        handles_[p.second] = vertex;
+    }
+}
+
+template <typename Kernel>
+void delaunay_index<Kernel>::remove(unsigned int id) {
+    if (!contains(id)) {
+        return;
+    }
+
+    graph_.remove(handles_[id]);
+    handles_[id] = vertex_handle();
+}
+
+template <typename Kernel>
+bool delaunay_index<Kernel>::contains(unsigned int id) const {
+    return id < handles_.size() && handles_[id] != vertex_handle();
+}
+
+template <typename Kernel>
+bool delaunay_index<Kernel>::nearest(const point2& p, scalar /*radius*/,
+        unsigned int& id) const {
+    if (graph_.number_of_vertices() == 0) {
+        return false;
+    }
+
+    id = graph_.nearest_vertex(convert(p))->info();
+    return true;
+}
+
+template <typename Kernel>
+void delaunay_index<Kernel>::relative_neighbors(const point2& p, scalar radius,
+        std::vector<unsigned int>& ids) const {
+    ids.clear();
+
+    auto q = convert(p);
+    // the points that would be adjacent to p in the triangulation
+    std::vector<vertex_handle> adjacent;
+
+    if (graph_.dimension() < 2) {
+        // too few points for faces, p would be adjacent to all of them
+        for (auto it = graph_.finite_vertices_begin();
+                it != graph_.finite_vertices_end(); ++it) {
+            if (it->point() != q) {
+                adjacent.push_back(it);
+            }
+        }
+    } else {
+        typename delaunay_indexed::Locate_type type;
+        int li;
+        auto face = graph_.locate(q, type, li);
+
+        if (type == delaunay_indexed::VERTEX) {
+            // p is already a vertex, it has that vertex's neighbors
+            auto nc = graph_.incident_vertices(face->vertex(li));
+            auto done(nc);
+
+            do {
+                if (!graph_.is_infinite(nc)) {
+                    adjacent.push_back(nc);
+                }
+            } while (++nc != done);
+        } else {
+            // inserting p would join it to every edge on the boundary
+            // of the faces whose circumcircles contain it
+            std::vector<typename delaunay_indexed::Edge> boundary;
+            graph_.get_boundary_of_conflicts(q, std::back_inserter(boundary), face);
+
+            for (const auto& edge : boundary) {
+                auto v = edge.first->vertex(graph_.ccw(edge.second));
+                if (!graph_.is_infinite(v)) {
+                    adjacent.push_back(v);
+                }
+            }
+        }
+    }
+
+    std::size_t k = adjacent.size();
+    std::vector<double> xs(k), ys(k), to_p(k), to_neighbor(k);
+
+    for (std::size_t i = 0; i < k; ++i) {
+        xs[i] = adjacent[i]->point().x();
+        ys[i] = adjacent[i]->point().y();
+    }
+
+    simd::squared_distances(xs.data(), ys.data(), k, (double)q.x(), (double)q.y(),
+        to_p.data());
+    double radius2 = (double)radius * radius;
+
+    for (std::size_t i = 0; i < k; ++i) {
+        if (to_p[i] >= radius2) {
+            continue;
+        }
+
+        // point v is in the relative neighborhood if
+        // (u in V) ||v - p|| < max{||u - p||, ||v - u||},
+        // compared here with squared distances
+        simd::squared_distances(xs.data(), ys.data(), k, xs[i], ys[i],
+            to_neighbor.data());
+        bool valid = true;
+
+        for (std::size_t j = 0; j < k; ++j) {
+            if (xs[j] == xs[i] && ys[j] == ys[i]) {
+                continue;
+            }
+
+            if (to_p[i] >= std::max(to_p[j], to_neighbor[j])) {
+                valid = false;
+                break;
+            }
+        }
+
+        if (valid) {
+            ids.push_back(adjacent[i]->info());
+        }
+    }
+}
+
+template <typename Kernel>
+grid_index<Kernel>::grid_index(scalar min_x, scalar min_y, scalar max_x, scalar max_y,
+        scalar cell_size)
+        : min_x_(min_x), min_y_(min_y), max_x_(max_x), max_y_(max_y),
+        cell_size_(cell_size) {
+    columns_ = std::max(1, (int)std::ceil((max_x - min_x) / cell_size));
+    rows_ = std::max(1, (int)std::ceil((max_y - min_y) / cell_size));
+    cells_.resize(columns_ * rows_);
+}
+
+template <typename Kernel>
+int grid_index<Kernel>::column(scalar x) const {
+    return std::clamp((int)std::floor((x - min_x_) / cell_size_), 0, columns_ - 1);
+}
+
+template <typename Kernel>
+int grid_index<Kernel>::row(scalar y) const {
+    return std::clamp((int)std::floor((y - min_y_) / cell_size_), 0, rows_ - 1);
+}
+
+template <typename Kernel>
+void grid_index<Kernel>::insert(const std::vector<entry>& points) {
+    for (const auto& p : points) {
+        int index = row(p.first.y()) * columns_ + column(p.first.x());
+        auto& c = cells_[index];
+
+        if (p.second >= cell_of_.size()) {
+            cell_of_.resize(p.second + 1, -1);
+            slot_of_.resize(p.second + 1);
+        }
+        cell_of_[p.second] = index;
+        slot_of_[p.second] = c.ids.size();
+
+        c.ids.push_back(p.second);
+        c.xs.push_back(p.first.x());
+        c.ys.push_back(p.first.y());
+    }
+}
+
+template <typename Kernel>
+void grid_index<Kernel>::remove(unsigned int id) {
+    if (!contains(id)) {
+        return;
+    }
+
+    auto& c = cells_[cell_of_[id]];
+    unsigned int i = slot_of_[id];
+
+    // swap with the last point to keep the arrays contiguous
+    c.ids[i] = c.ids.back();
+    c.xs[i] = c.xs.back();
+    c.ys[i] = c.ys.back();
+    slot_of_[c.ids[i]] = i;
+    c.ids.pop_back();
+    c.xs.pop_back();
+    c.ys.pop_back();
+
+    cell_of_[id] = -1;
+}
+
+template <typename Kernel>
+bool grid_index<Kernel>::contains(unsigned int id) const {
+    return id < cell_of_.size() && cell_of_[id] >= 0;
+}
+
+/**
+ * Searches rings of cells outward from p's cell until no closer point,
+ * or no point closer than radius, can exist in the remaining rings.
+ */
+template <typename Kernel>
+bool grid_index<Kernel>::nearest(const point2& p, scalar radius,
+        unsigned int& id) const {
+    scalar x = p.x();
+    scalar y = p.y();
+    int cx = column(x);
+    int cy = row(y);
+
+    // a query outside the bounds is this much closer to the outer rings
+    scalar outside_x = std::max({ scalar(0), min_x_ - x, x - max_x_ });
+    scalar outside_y = std::max({ scalar(0), min_y_ - y, y - max_y_ });
+    scalar outside = std::sqrt(outside_x * outside_x + outside_y * outside_y);
+
+    scalar best = std::numeric_limits<scalar>::infinity();
+    bool found = false;
+    int max_ring = std::max(columns_, rows_);
+
+    for (int r = 0; r <= max_ring; ++r) {
+        // every point in ring r is at least this far from p
+        scalar bound = std::max(scalar(0), (r - 1) * cell_size_ - outside);
+        if (best <= bound * bound || bound >= radius) {
+            break;
+        }
+
+        for (int j = cy - r; j <= cy + r; ++j) {
+            if (j < 0 || j >= rows_) {
+                continue;
+            }
+
+            // only the first and last rows of the ring are filled in
+            int step = (j == cy - r || j == cy + r) ? 1 : std::max(1, 2 * r);
+
+            for (int i = cx - r; i <= cx + r; i += step) {
+                if (i < 0 || i >= columns_) {
+                    continue;
+                }
+
+                const auto& c = cells_[j * columns_ + i];
+                for (std::size_t k = 0; k < c.ids.size(); ++k) {
+                    scalar dx = c.xs[k] - x;
+                    scalar dy = c.ys[k] - y;
+                    scalar d = dx * dx + dy * dy;
+                    if (d < best) {
+                        best = d;
+                        id = c.ids[k];
+                        found = true;
+                    }
+                }
+            }
+        }
+    }
+
+    return found;
+}
+
+/**
+ * A point u closer to p than v is also closer to v than p is whenever
+ * the angle between them at p is under 60 degrees, and never when it is
+ * over 90. So once a point has been visited every direction within 60
+ * degrees of it is blocked for the points after it, and the points in
+ * the remaining directions only need to be checked against the visited
+ * points. The directions are tracked in bins of one degree.
+ */
+template <typename Kernel>
+void grid_index<Kernel>::relative_neighbors(const point2& p, scalar radius,
+        std::vector<unsigned int>& ids) const {
+    struct candidate {
+        unsigned int id;
+        scalar x;
+        scalar y;
+        scalar distance2;
+    };
+
+    constexpr int bins = 360;
+    constexpr scalar degrees = 180.0 / 3.14159265358979323846;
+
+    ids.clear();
+
+    scalar x = p.x();
+    scalar y = p.y();
+    int cx = column(x);
+    int cy = row(y);
+
+    // a query outside the bounds is this much closer to the outer rings
+    scalar outside_x = std::max({ scalar(0), min_x_ - x, x - max_x_ });
+    scalar outside_y = std::max({ scalar(0), min_y_ - y, y - max_y_ });
+    scalar outside = std::sqrt(outside_x * outside_x + outside_y * outside_y);
+
+    scalar radius2 = radius * radius;
+    int max_ring = std::max(columns_, rows_);
+
+    // gathered points not yet visited, the closest at the back
+    std::vector<candidate> pending;
+    std::vector<candidate> visited;
+    std::array<bool, bins> blocked{};
+    int num_blocked = 0;
+
+    for (int r = 0; ; ++r) {
+        for (int j = cy - r; j <= cy + r; ++j) {
+            if (j < 0 || j >= rows_) {
+                continue;
+            }
+
+            // only the first and last rows of the ring are filled in
+            int step = (j == cy - r || j == cy + r) ? 1 : std::max(1, 2 * r);
+
+            for (int i = cx - r; i <= cx + r; i += step) {
+                if (i < 0 || i >= columns_) {
+                    continue;
+                }
+
+                const auto& c = cells_[j * columns_ + i];
+                for (std::size_t k = 0; k < c.ids.size(); ++k) {
+                    scalar dx = c.xs[k] - x;
+                    scalar dy = c.ys[k] - y;
+                    scalar d = dx * dx + dy * dy;
+                    if (d < radius2) {
+                        pending.push_back({ c.ids[k], c.xs[k], c.ys[k], d });
+                    }
+                }
+            }
+        }
+
+        // every point closer than this has been gathered
+        scalar reached = std::max(scalar(0), r * cell_size_ - outside);
+        bool last = r >= max_ring || reached >= radius;
+
+        std::sort(pending.begin(), pending.end(),
+            [](const candidate& a, const candidate& b) {
+                return a.distance2 > b.distance2
+                    || (a.distance2 == b.distance2 && a.id > b.id);
+            });
+
+        while (!pending.empty()
+                && (last || pending.back().distance2 < reached * reached)) {
+            candidate v = pending.back();
+            pending.pop_back();
+
+            scalar angle = std::atan2(v.y - y, v.x - x) * degrees + 180;
+            bool valid = !blocked[std::min(bins - 1, (int)angle)];
+
+            if (valid) {
+                for (const auto& u : visited) {
+                    if (u.x == v.x && u.y == v.y) {
+                        continue;
+                    }
+
+                    scalar ex = u.x - v.x;
+                    scalar ey = u.y - v.y;
+                    if (v.distance2 >= std::max(u.distance2, ex * ex + ey * ey)) {
+                        valid = false;
+                        break;
+                    }
+                }
+            }
+
+            if (valid) {
+                ids.push_back(v.id);
+            }
+
+            // block the bins lying entirely within 60 degrees of v
+            int first = (int)std::floor(angle - 60) + 1;
+            int end = (int)std::ceil(angle + 60) - 2;
+            for (int b = first; b <= end; ++b) {
+                int bin = (b % bins + bins) % bins;
+                if (!blocked[bin]) {
+                    blocked[bin] = true;
+                    ++num_blocked;
+                }
+            }
+
+            visited.push_back(v);
+        }
+
+        // the remaining points are all blocked once every direction is
+        if (last || num_blocked == bins) {
+            break;
+        }
+    }
+}
+
+template class growth::spatial_index<growth::float_kernel>;
+template class growth::spatial_index<growth::double_kernel>;
+template class growth::spatial_index<growth::cgal_kernel>;
+template class growth::delaunay_index<growth::float_kernel>;
+template class growth::delaunay_index<growth::double_kernel>;
+template class growth::delaunay_index<growth::cgal_kernel>;
+template class growth::grid_index<growth::float_kernel>;
+template class growth::grid_index<growth::double_kernel>;
+template class growth::grid_index<growth::cgal_kernel>;
@@ -0,0 +1,106 @@
+#include <algorithm>
+
+#include "growth/thread_pool.hpp"
+
+using namespace growth;
+
+thread_pool::thread_pool(unsigned int threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // the calling thread is the last worker
+    for (unsigned int i = 1; i < threads; ++i) {
+        workers_.emplace_back(&thread_pool::work, this);
+    }
+}
+
+thread_pool::~thread_pool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+
+    start_.notify_all();
+
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+/**
+ * Claims and runs indices of the current task until none are left.
+ */
+void thread_pool::run_tasks(const std::function<void(std::size_t)>& task,
+        std::size_t count) {
+    std::size_t i;
+    while ((i = next_.fetch_add(1)) < count) {
+        task(i);
+    }
+}
+
+void thread_pool::work() {
+    unsigned long seen = 0;
+
+    while (true) {
+        const std::function<void(std::size_t)>* task;
+        std::size_t count;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_.wait(lock, [&] { return stop_ || generation_ != seen; });
+
+            if (stop_) {
+                return;
+            }
+
+            seen = generation_;
+            task = task_;
+            count = count_;
+        }
+
+        run_tasks(*task, count);
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            last = --pending_ == 0;
+        }
+
+        if (last) {
+            finished_.notify_one();
+        }
+    }
+}
+
+void thread_pool::parallel_for(std::size_t n, const std::function<void(std::size_t)>& fn) {
+    if (n == 0) {
+        return;
+    }
+
+    // not worth waking the workers
+    if (workers_.empty() || n == 1) {
+        for (std::size_t i = 0; i < n; ++i) {
+            fn(i);
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &fn;
+        count_ = n;
+        next_ = 0;
+        pending_ = workers_.size();
+        ++generation_;
+    }
+
+    start_.notify_all();
+    run_tasks(fn, n);
+
+    // wait until every worker has been through this generation, even
+    // those woken after the indices ran out
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait(lock, [&] { return pending_ == 0; });
+    task_ = nullptr;
+}
@@ -0,0 +1,207 @@
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+
+#include "growth/trace.hpp"
+
+using namespace growth;
+using namespace growth::trace;
+
+namespace {
+
+    const char* const phase_names[num_phases] = {
+        "step", "associate", "grow", "consume", "prune", "maintain",
+        "update_width", "draw"
+    };
+
+    const char* const counter_names[num_counters] = {
+        "attractors_visited", "nearest_queries", "neighbor_queries",
+        "nodes_added", "attractors_added", "attractors_removed", "nodes_pruned",
+        "nodes_retired"
+    };
+
+    /**
+     * The open trace. The totals are atomic so recording only takes the
+     * lock to write a Chrome trace event.
+     */
+    struct recorder {
+        std::atomic<bool> active{false};
+        std::array<std::atomic<std::uint64_t>, num_phases> nanoseconds{};
+        std::array<std::atomic<std::uint64_t>, num_counters> counts{};
+
+        // guards the file
+        std::mutex mutex;
+        std::ofstream out;
+        format style = format::json_lines;
+        clock::time_point origin;
+        bool first_event = true;
+    };
+
+    recorder& get() {
+        static recorder r;
+        return r;
+    }
+
+    // small ids for the threads, in the order they first record
+    int thread_number() {
+        static std::atomic<int> next{0};
+        thread_local int n = next++;
+        return n;
+    }
+
+    double microseconds(clock::duration d) {
+        return std::chrono::duration<double, std::micro>(d).count();
+    }
+
+    void begin_event(recorder& r) {
+        if (!r.first_event) {
+            r.out << ",\n";
+        }
+
+        r.first_event = false;
+    }
+
+}
+
+bool trace::open(const std::string& path, format f) {
+    close();
+
+    auto& r = get();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    r.out.open(path, std::ios::out | std::ios::trunc);
+    if (!r.out) {
+        return false;
+    }
+
+    r.style = f;
+    r.origin = clock::now();
+    r.first_event = true;
+
+    for (auto& ns : r.nanoseconds) {
+        ns = 0;
+    }
+
+    for (auto& count : r.counts) {
+        count = 0;
+    }
+
+    if (f == format::csv) {
+        r.out << "step,time_us";
+        for (const auto name : phase_names) {
+            r.out << ',' << name << "_us";
+        }
+        for (const auto name : counter_names) {
+            r.out << ',' << name;
+        }
+        r.out << '\n';
+    } else if (f == format::chrome) {
+        r.out << "{\"traceEvents\":[\n";
+    }
+
+    r.active.store(true, std::memory_order_release);
+    return true;
+}
+
+void trace::close() {
+    auto& r = get();
+    if (!r.active.exchange(false)) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    if (r.style == format::chrome) {
+        r.out << "\n]}\n";
+    }
+
+    r.out.close();
+}
+
+void trace::record(phase p, clock::time_point start, clock::time_point end) {
+    auto& r = get();
+    if (!r.active.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    auto i = static_cast<unsigned int>(p);
+    r.nanoseconds[i].fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count(),
+        std::memory_order_relaxed);
+
+    if (r.style != format::chrome || p == phase::update_width) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(r.mutex);
+    begin_event(r);
+    r.out << "{\"name\":\"" << phase_names[i] << "\",\"ph\":\"X\",\"pid\":1"
+        << ",\"tid\":" << thread_number()
+        << ",\"ts\":" << microseconds(start - r.origin)
+        << ",\"dur\":" << microseconds(end - start) << '}';
+}
+
+void trace::add(counter c, std::uint64_t n) {
+    auto& r = get();
+    if (!r.active.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    r.counts[static_cast<unsigned int>(c)].fetch_add(n, std::memory_order_relaxed);
+}
+
+void trace::end_step(unsigned long step) {
+    auto& r = get();
+    if (!r.active.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    std::array<double, num_phases> phase_us;
+    std::array<std::uint64_t, num_counters> counts;
+
+    for (unsigned int i = 0; i < num_phases; ++i) {
+        phase_us[i] = r.nanoseconds[i].exchange(0, std::memory_order_relaxed) / 1000.0;
+    }
+
+    for (unsigned int i = 0; i < num_counters; ++i) {
+        counts[i] = r.counts[i].exchange(0, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(r.mutex);
+    double time_us = microseconds(clock::now() - r.origin);
+
+    if (r.style == format::json_lines) {
+        r.out << "{\"step\":" << step << ",\"time_us\":" << time_us
+            << ",\"phases_us\":{";
+        for (unsigned int i = 0; i < num_phases; ++i) {
+            r.out << (i > 0 ? "," : "") << '"' << phase_names[i] << "\":" << phase_us[i];
+        }
+        r.out << "},\"counters\":{";
+        for (unsigned int i = 0; i < num_counters; ++i) {
+            r.out << (i > 0 ? "," : "") << '"' << counter_names[i] << "\":" << counts[i];
+        }
+        r.out << "}}\n";
+    } else if (r.style == format::csv) {
+        r.out << step << ',' << time_us;
+        for (const auto us : phase_us) {
+            r.out << ',' << us;
+        }
+        for (const auto count : counts) {
+            r.out << ',' << count;
+        }
+        r.out << '\n';
+    } else {
+        // the phases already have their events, only the counts and
+        // the phases without events are added
+        auto width = static_cast<unsigned int>(phase::update_width);
+        begin_event(r);
+        r.out << "{\"name\":\"counts\",\"ph\":\"C\",\"pid\":1,\"tid\":0"
+            << ",\"ts\":" << time_us << ",\"args\":{\"step\":" << step
+            << ",\"" << phase_names[width] << "_us\":" << phase_us[width];
+        for (unsigned int i = 0; i < num_counters; ++i) {
+            r.out << ",\"" << counter_names[i] << "\":" << counts[i];
+        }
+        r.out << "}}";
+    }
+}
@@ -1,57 +1,128 @@
 #include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <map>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
 
 #include <boost/gil/extension/numeric/sampler.hpp>
 #include <boost/gil/extension/numeric/resample.hpp>
 
-#ifdef __APPLE__
-#define GL_SILENCE_DEPRECATION
-#endif
-
-#include <GLFW/glfw3.h>
-
+#include "growth/poisson_disk.hpp"
+#include "growth/rng.hpp"
+#include "growth/simd.hpp"
+#include "growth/trace.hpp"
 #include "growth/venation.hpp"
 #include "img.hpp"
 #include "util.hpp"
 
 using namespace growth;
 
-venation& venation::configure(unsigned int width, unsigned int height) {
+namespace {
+
+    using steady = std::chrono::steady_clock;
+
+    /**
+     * Adds the seconds since start to total and to the trace's phase,
+     * then restarts from now.
+     */
+    void lap(steady::time_point& start, double& total, trace::phase p) {
+        auto now = steady::now();
+        total += std::chrono::duration<double>(now - start).count();
+        if constexpr (trace::enabled) {
+            trace::record(p, start, now);
+        }
+        start = now;
+    }
+
+    /**
+     * The key of the cell of a grid with the given cell size holding
+     * (x, y), offset by whole cells.
+     */
+    std::int64_t cell_key(double x, double y, double size, int dx = 0, int dy = 0) {
+        std::int64_t column = (std::int64_t)std::floor(x / size) + dx;
+        std::int64_t row = (std::int64_t)std::floor(y / size) + dy;
+        return (column << 32) ^ (row & 0xffffffff);
+    }
+
+}
+
+template <typename Kernel>
+basic_venation<Kernel>& basic_venation<Kernel>::configure(unsigned int width,
+        unsigned int height) {
     width_ = width;
     height_ = height;
     aspect_ratio_ = double(width) / double(height);
     return *this;
 }
 
-venation& venation::seeds(const std::vector<venation::point2>& seeds) {
+template <typename Kernel>
+basic_venation<Kernel>& basic_venation<Kernel>::seeds(const std::vector<point2>& seeds) {
     seeds_.clear();
     for (const auto& seed : seeds) {
-        seeds_.push_back(venation::point2(seed.x() * aspect_ratio_, seed.y()));
+        seeds_.push_back(point2(seed.x() * aspect_ratio_, seed.y()));
     }
 
     return *this;
 }
 
-venation& venation::mode(const std::string& mode) {
+template <typename Kernel>
+basic_venation<Kernel>& basic_venation<Kernel>::mode(const std::string& mode) {
     if (mode.compare("closed") == 0) {
-        mode_ = venation::type::closed;
+        mode_ = type::closed;
     } else {
-        mode_ = venation::type::open;
+        mode_ = type::open;
     }
 
     return *this;
 }
 
-venation& venation::mask(const boost::gil::rgb8_image_t& img) {
-    mask_img_ = img;
+template <typename Kernel>
+basic_venation<Kernel>& basic_venation<Kernel>::index(const std::string& index) {
+    if (index.compare("grid") == 0) {
+        index_type_ = index_type::grid;
+    } else {
+        index_type_ = index_type::delaunay_graph;
+    }
+
+    return *this;
+}
+
+template <typename Kernel>
+basic_venation<Kernel>& basic_venation<Kernel>::placement(const std::string& placement) {
+    if (placement.compare("poisson") == 0) {
+        placement_ = placement_type::blue_noise;
+    } else {
+        placement_ = placement_type::white_noise;
+    }
+
+    return *this;
+}
+
+template <typename Kernel>
+basic_venation<Kernel>& basic_venation<Kernel>::mask(
+        const boost::gil::rgb8_image_t& img) {
+    return mask(std::make_shared<const boost::gil::rgb8_image_t>(img));
+}
+
+template <typename Kernel>
+basic_venation<Kernel>& basic_venation<Kernel>::mask(
+        std::shared_ptr<const boost::gil::rgb8_image_t> img) {
+    mask_img_ = std::move(img);
     mask_given_ = true;
     // Reconfigure. The input image's dimensions trump any configuration.
-    configure(mask_img_.width(), mask_img_.height());
+    configure(mask_img_->width(), mask_img_->height());
     return *this;
 }
 
-void venation::scale_to_fit(int window_width, int window_height) {
+template <typename Kernel>
+void basic_venation<Kernel>::scale_to_fit(int window_width, int window_height) {
     auto width = width_;
     auto height = height_;
     
@@ -67,102 +138,217 @@ void venation::scale_to_fit(int window_width, int window_height) {
         width = (unsigned int)((double)height * aspect_ratio_);
     }
 
-    // if the size has changed reconfigure and resize image
+    // if the size has changed reconfigure and resize image, the
+    // resized copy replaces a shared mask rather than changing it. A
+    // loaded simulation has no image, its quantized mask is kept as is
+    // and only the size it is drawn at changes.
     if (width != width_ || height != height_) {
-        boost::gil::rgb8_image_t new_mask_img(width, height);
-        boost::gil::resize_view(const_view(mask_img_), view(new_mask_img), 
-            boost::gil::bilinear_sampler());
-        mask_img_ = new_mask_img;
+        if (mask_given_ && mask_img_) {
+            auto new_mask_img = std::make_shared<boost::gil::rgb8_image_t>(width, height);
+            boost::gil::resize_view(const_view(*mask_img_), view(*new_mask_img), 
+                boost::gil::bilinear_sampler());
+            mask_img_ = new_mask_img;
+        }
         configure(width, height);
     }
 }
 
 /**
- * Converts the image to a vector representation for
- * easy lookup during the simulation.
+ * Converts the image to black and white, then builds the table the
+ * attractors are drawn from, each pixel weighted by its brightness.
  */
-void venation::prepare_mask() {
+template <typename Kernel>
+void basic_venation<Kernel>::prepare_mask() {
     if (!mask_given_) {
         return;
     }
 
+    mask_width_ = mask_img_->width();
+    mask_height_ = mask_img_->height();
     mask_data_.clear();
-    mask_data_.reserve(mask_img_.width() * mask_img_.height());
+    mask_data_.reserve(mask_width_ * mask_height_);
 
     // convert the image to black and white
     boost::gil::for_each_pixel(
-        boost::gil::const_view(mask_img_), 
+        boost::gil::const_view(*mask_img_), 
         img::BlackAndWhitePixelInserter(&mask_data_, mask_shades_)
     );
+
+    mask_table_ = alias_table(mask_data_);
 }
 
 /**
- * Generates an initial set of attractors
+ * Generates an initial set of attractors, spread as the placement asks.
  */
-void venation::generate_attractors() {
-    double x;
-    double y;
-    std::vector<venation::point2> attractors;
-
-    // generate random points
-    for (int i = 0; i < num_attractors_; ++i) {
-        x = (util::rnd() * 2.0 - 1.0) * aspect_ratio_;
-        y = util::rnd() * 2.0 - 1.0;
-        venation::point2 p(x, y);
-
-        if (mask_data_.size() == 0) {
-            attractors.push_back(p);
-        } else {
-            // Keep the attractor based on the brightness of the
-            // mask's corresponding pixel as probability.
-            int ix = (int)round((x * 0.5 + 0.5) * (float)width_);
-            int iy = (int)round((y * 0.5 + 0.5) * (float)height_);
-            float brightness = mask_data_[(height_ - iy) * width_ + ix];
-            if (util::rnd() < brightness) {
-                attractors.push_back(p);
+template <typename Kernel>
+void basic_venation<Kernel>::generate_attractors() {
+    std::vector<point2> attractors;
+    if (placement_ == placement_type::blue_noise) {
+        attractors = poisson_attractors();
+    } else {
+        attractors = random_attractors();
+    }
+
+    attractors_.clear();
+    attractors_.insert(attractors);
+
+    // cells small enough that waking around a new node only checks
+    // attractors near it
+    attractors_.partition(-aspect_ratio_, -1.0, aspect_ratio_, 1.0, growth_radius_ / 4.0);
+    sleep_radius_ = std::numeric_limits<scalar>::infinity();
+}
+
+/**
+ * Places the attractors independently at random. With a mask each
+ * attractor is placed in a pixel drawn in proportion to its brightness,
+ * jittered within it, so every one of them lands in the mask. Attractor
+ * i's position only depends on the seed and i, so chunks of attractors
+ * are generated in parallel and concatenated in order.
+ */
+template <typename Kernel>
+std::vector<typename Kernel::Point_2> basic_venation<Kernel>::random_attractors() {
+    // a black mask leaves nowhere to put them
+    std::size_t count = mask_given_ && mask_table_.empty() ? 0 : num_attractors_;
+    std::size_t num_chunks = (count + chunk_size - 1) / chunk_size;
+    std::vector<std::vector<point2>> chunks(num_chunks);
+    int mask_width = mask_given_ ? mask_img_->width() : 0;
+    int mask_height = mask_given_ ? mask_img_->height() : 0;
+
+    pool().parallel_for(num_chunks, [&](std::size_t chunk) {
+        std::size_t end = std::min(count, (chunk + 1) * chunk_size);
+        chunks[chunk].reserve(end - chunk * chunk_size);
+
+        // generate random points
+        for (std::size_t i = chunk * chunk_size; i < end; ++i) {
+            double u[4];
+            for (int k = 0; k < 4; ++k) {
+                u[k] = rng::uniform(seed_, rng::attractors, 4 * i + k);
             }
+
+            double x, y;
+            if (!mask_given_) {
+                x = u[0] * 2.0 - 1.0;
+                y = u[1] * 2.0 - 1.0;
+            } else {
+                // the pixel's row counts down from the top
+                std::size_t pixel = mask_table_.sample(u[0], u[1]);
+                int column = pixel % mask_width;
+                int row = pixel / mask_width;
+                x = (column + u[2]) / mask_width * 2.0 - 1.0;
+                y = 1.0 - (row + u[3]) / mask_height * 2.0;
+            }
+
+            chunks[chunk].push_back(point2(x * aspect_ratio_, y));
         }
+    });
+
+    std::vector<point2> attractors;
+    for (const auto& chunk : chunks) {
+        attractors.insert(attractors.end(), chunk.begin(), chunk.end());
     }
 
-    // add them to delaunay triangulation graph
-    attractors_graph_.insert(attractors.begin(), attractors.end());
+    return attractors;
 }
 
 /**
- * Inserts a single point into the nodes graph.
+ * Places about num_attractors evenly spaced attractors, none closer to
+ * another than a radius which shrinks in brighter parts of the mask.
+ * Without the clumps and gaps of random placement fewer attractors give
+ * the same density of veins, and fewer steps are spent on regions no
+ * attractor reaches into.
  */
-std::ptrdiff_t venation::insert_node(const venation::point2& p) {
-    // vertex with info needs to be inserted to the graph via vector
-    std::vector<std::pair<venation::point2, unsigned int>> nodes{
-        std::make_pair(p, nodes_.size())
-    };
-    return nodes_graph_.insert(nodes.begin(), nodes.end());
+template <typename Kernel>
+std::vector<typename Kernel::Point_2> basic_venation<Kernel>::poisson_attractors() {
+    poisson_disk sampler(-aspect_ratio_, -1.0, aspect_ratio_, 1.0);
+    if (mask_given_) {
+        sampler.density(mask_data_, mask_img_->width(), mask_img_->height());
+    }
+
+    auto points = sampler.generate(num_attractors_, pool(), seed_, rng::attractors);
+
+    std::vector<point2> attractors;
+    attractors.reserve(points.size());
+    for (const auto& p : points) {
+        attractors.push_back(point2(p.first, p.second));
+    }
+
+    return attractors;
+}
+
+/**
+ * Creates the spatial index over the nodes.
+ */
+template <typename Kernel>
+void basic_venation<Kernel>::create_index() {
+    if (index_type_ == index_type::grid) {
+        // cells small enough that a nearest query only visits a few
+        // nodes once the structure has filled in
+        double cell_size = std::max(growth_radius_ / 16.0, consume_radius_ * 2.0);
+        nodes_index_ = std::make_unique<grid_index<Kernel>>(
+            -aspect_ratio_, -1.0, aspect_ratio_, 1.0, cell_size);
+    } else {
+        nodes_index_ = std::make_unique<delaunay_index<Kernel>>();
+    }
 }
 
 /*
  * Seed the growth.
  */
-void venation::create_seeds() {
+template <typename Kernel>
+void basic_venation<Kernel>::create_seeds() {
     if (seeds_.size() == 0) {
-        seeds_.push_back(venation::point2(0.0, 0.0));
+        seeds_.push_back(point2(0.0, 0.0));
     }
 
     nodes_.clear();
+    prune_candidates_.clear();
+    front_.clear();
+    archive_.clear();
+    retire_radius_ = std::numeric_limits<scalar>::infinity();
 
     for (const auto& seed : seeds_) {
-        // insert node to dilaunay graph
-        insert_node(seed);
-        // add the node to the node index vector.
-        auto dir = util::normalize(venation::vector2(util::rnd(), util::rnd()));
-        nodes_.push_back(node::create(seed, dir));
+        node_id n = nodes_.size();
+
+        // insert node to the spatial index
+        front_.push_back(n);
+        nodes_index_->insert({ std::make_pair(seed, n) });
+        // add the node to the node arena.
+        auto dir = util::normalize(vector2(
+            rng::uniform(seed_, rng::seeds, 2 * n),
+            rng::uniform(seed_, rng::seeds, 2 * n + 1)));
+        nodes_.create(seed, dir);
+    }
+}
+
+/**
+ * Adds a node to the tree, noting it as a pruning candidate if it
+ * starts a line from a seed's child.
+ */
+template <typename Kernel>
+node_id basic_venation<Kernel>::create_node(const point2& p, const vector2& d,
+        node_id parent) {
+    node_id n = nodes_.create(p, d, parent);
+    GROWTH_TRACE_COUNT(nodes_added, 1);
+
+    if (defer_pruning_) {
+        return n;
+    }
+
+    node_id grandparent = nodes_.parent[parent];
+    if (grandparent != no_node && nodes_.parent[grandparent] == no_node
+            && nodes_.first_child[parent] == n) {
+        prune_candidates_.push_back(std::make_pair(grandparent, parent));
     }
+
+    return n;
 }
 
 /**
  * Returns the current growth radius as the base growth radius
  * multiplied by the 2 to the no grwoth count.
  */
-long double venation::growth_radius() {
+template <typename Kernel>
+typename basic_venation<Kernel>::scalar basic_venation<Kernel>::growth_radius() {
     return growth_radius_ * pow(2.0, no_growth_count_);
 }
 
@@ -170,20 +356,38 @@ long double venation::growth_radius() {
  * Returns the current growth rate as the base growth rate
  * multiplied by the 2 to the no grwoth count.
  */
-long double venation::growth_rate() {
+template <typename Kernel>
+typename basic_venation<Kernel>::scalar basic_venation<Kernel>::growth_rate() {
     return growth_rate_ * pow(2.0, no_growth_count_);
 }
 
-void venation::setup() {
+template <typename Kernel>
+void basic_venation<Kernel>::setup() {
+    timings_ = phase_times();
+    source_active_ = source_ != nullptr;
     prepare_mask();
     generate_attractors();
+    create_index();
     create_seeds();
 }
 
+/**
+ * Returns the thread pool, starting it on first use.
+ */
+template <typename Kernel>
+thread_pool& basic_venation<Kernel>::pool() {
+    if (!pool_) {
+        pool_ = std::make_unique<thread_pool>(threads_);
+    }
+
+    return *pool_;
+}
+
 /**
  * Performs the node growth (colonization) step of the algorithm.
  */
-void venation::grow(const std::map<unsigned int, venation::vector2>& influences) {
+template <typename Kernel>
+void basic_venation<Kernel>::grow(const std::map<unsigned int, vector2>& influences) {
     if (influences.size() == 0) {
         ++no_growth_count_;
         return;
@@ -191,37 +395,40 @@ void venation::grow(const std::map<unsigned int, venation::vector2>& influences)
 
     bool has_grown = false;
     
-    std::vector<std::pair<venation::point2, unsigned int>> new_points;
+    std::vector<std::pair<point2, unsigned int>> new_points;
     
     for (const auto& i : influences) {
-        node_ref parent = nodes_[i.first];
+        node_id parent = i.first;
+        auto parent_position = nodes_.position(parent);
+        auto parent_direction = nodes_.direction(parent);
 
         // 3. util::normalize each vector sum
         auto d = util::normalize(i.second);
-        auto diff = parent->direction - d * -1.0;
+        auto diff = parent_direction - d * -1.0;
 
         // if the growth direction is the inverse of the previous growth
         // direction we must just continue on, we cannot grow backwards
         if (std::abs(diff.x()) < 0.01 && std::abs(diff.y()) < 0.01) {
-            d = parent->direction;
+            d = parent_direction;
         }
 
         // 4. add new node
         auto step = d * growth_rate();
-        venation::point2 child_pos(
-            parent->position.x() + step.x(),
-            parent->position.y() + step.y()
+        point2 child_pos(
+            parent_position.x() + step.x(),
+            parent_position.y() + step.y()
         );
 
-        auto growth_amount = util::distance(child_pos, parent->position);
+        auto growth_amount = util::distance(child_pos, parent_position);
         if (growth_amount > growth_rate_ * 2.0) {
             continue;
         }
 
         // check if node already exists
         bool exists = false;
-        for (const auto& c : parent->children) {
-            if (c->position == child_pos) {
+        for (node_id c = nodes_.first_child[parent]; c != no_node;
+                c = nodes_.next_sibling[c]) {
+            if (nodes_.position(c) == child_pos) {
                 exists = true;
                 break;
             }
@@ -232,37 +439,39 @@ void venation::grow(const std::map<unsigned int, venation::vector2>& influences)
         }
 
         // node does not exist, add it to grow the structure
-        auto dir = util::normalize(child_pos - parent->position);
-        auto child_node = node::create(child_pos, dir);
-        new_points.push_back(std::make_pair(child_pos, nodes_.size()));
-        parent->children.push_back(child_node);
-        nodes_.push_back(child_node);
+        auto dir = util::normalize(child_pos - parent_position);
+        new_points.push_back(std::make_pair(child_pos, (node_id)nodes_.size()));
+        front_.push_back(create_node(child_pos, dir, parent));
+        attractors_.wake(child_pos.x(), child_pos.y(), sleep_radius_);
         has_grown = true;
     }
 
     if (has_grown) {
         no_growth_count_ = std::max(0, no_growth_count_ - 1);
-        nodes_graph_.insert(new_points.begin(), new_points.end());
+        nodes_index_->insert(new_points);
     } else {
         ++no_growth_count_;
     }
 }
 
 /**
- * Checks if node with id node_id is or any of its children are
+ * Checks if node with id n is or any of its children are
  * within the kill radius of attractor at point s.
  */
-bool venation::has_consumed(unsigned int node_id, const venation::point2& s) {
-    node_ref node = nodes_[node_id];
+template <typename Kernel>
+bool basic_venation<Kernel>::has_consumed(node_id n, const point2& s) {
+    // compared squared, there are too few children to batch
+    scalar radius2 = consume_radius_ * consume_radius_;
 
-    // check if the node is within kill util::distance
-    if (util::distance(node->position, s) < consume_radius_) {
+    // check if the node is within kill distance
+    if (squared_distance(nodes_.position(n), s) < radius2) {
         return true;
     }
 
-    // otherwise, check if any childen are within kill util::distance
-    for (const auto& child : node->children) {
-        if (util::distance(s, child->position) < consume_radius_) {
+    // otherwise, check if any childen are within kill distance
+    for (node_id child = nodes_.first_child[n]; child != no_node;
+            child = nodes_.next_sibling[child]) {
+        if (squared_distance(s, nodes_.position(child)) < radius2) {
             return true;
         }
     }
@@ -270,142 +479,296 @@ bool venation::has_consumed(unsigned int node_id, const venation::point2& s) {
     return false;
 }
 
+/**
+ * Brings the attractor's cached closest node up to date. Only the nodes
+ * created since the last update are compared against, a full search of
+ * the nodes graph is needed only if the cached node has since been pruned
+ * or retired. The search gives up at the growth radius, leaving the
+ * attractor at an infinite distance until a node is created close to it.
+ */
+template <typename Kernel>
+void basic_venation<Kernel>::update_nearest(std::size_t a) {
+    auto attractor = attractors_.position(a);
+    auto& node = attractors_.nearest_node[a];
+    auto& distance = attractors_.nearest_distance[a];
+    auto& seen = attractors_.nearest_seen[a];
+
+    if (seen == 0 || !nodes_index_->contains(node)) {
+        GROWTH_TRACE_COUNT(nearest_queries, 1);
+        if (nodes_index_->nearest(attractor, growth_radius(), node)) {
+            distance = util::distance(attractor, nodes_.position(node));
+        } else {
+            distance = std::numeric_limits<scalar>::infinity();
+        }
+
+        seen = nodes_.size();
+        return;
+    }
+
+    std::size_t count = nodes_.size() - seen;
+    scalar distance2;
+    std::size_t i = simd::nearest(nodes_.x.data() + seen, nodes_.y.data() + seen,
+        nodes_.live.data() + seen, count, attractors_.x[a], attractors_.y[a],
+        distance2);
+
+    if (i != count && std::sqrt(distance2) < distance) {
+        node = seen + i;
+        distance = std::sqrt(distance2);
+    }
+
+    seen = nodes_.size();
+}
+
 /**
  * Performs a single iteration of the open venation algorithm.
  */
-void venation::open_step() {
-    // find the closest node to each attractor.
-    std::map<unsigned int, venation::vector2> influences;
-    std::vector<venation::attractor_handle> influencing_attractors;
-
-    for (auto it = attractors_graph_.finite_vertices_begin();
-            it != attractors_graph_.finite_vertices_end(); ++it) {
-        // 1. associate every attractor with a growth node
-        auto attractor = it->point();
-        auto vertex = nodes_graph_.nearest_vertex(attractor);
-        auto point = vertex->point();
-        auto index = vertex->info();
-        auto dist = util::distance(attractor, point);
-
-        if (dist > consume_radius_ * 0.01 && dist < growth_radius()) {
-            influencing_attractors.push_back(it);
-            // 2. sum the difference vectors for each node
-            auto weight = std::max(consume_radius_, (long double)dist);
-            venation::vector2 d = util::normalize(attractor - point) / weight;
-            auto l = influences.find(index);
+template <typename Kernel>
+void basic_venation<Kernel>::open_step() {
+    auto t = steady::now();
+
+    // If the index can't be shared searching it is left to this
+    // thread, workers then only compare against newly created nodes.
+    if (!nodes_index_->concurrent()) {
+        for (const auto a : attractors_.active()) {
+            if (attractors_.alive(a) && (attractors_.nearest_seen[a] == 0
+                    || !nodes_index_->contains(attractors_.nearest_node[a]))) {
+                update_nearest(a);
+            }
+        }
+    }
+
+    // The attractors are split into fixed size chunks, each accumulating
+    // into its own buffer. Merging the buffers in chunk order sums the
+    // influences in the same order regardless of the number of threads.
+    struct influence_buffer {
+        std::vector<std::pair<unsigned int, vector2>> influences;
+        std::vector<std::size_t> attractors;
+    };
+
+    const auto& active = attractors_.active();
+    std::size_t num_attractors = active.size();
+    std::size_t num_chunks = (num_attractors + chunk_size - 1) / chunk_size;
+    std::vector<influence_buffer> buffers(num_chunks);
+    scalar radius = growth_radius();
+
+    pool().parallel_for(num_chunks, [&](std::size_t chunk) {
+        auto& buffer = buffers[chunk];
+        std::size_t end = std::min(num_attractors, (chunk + 1) * chunk_size);
+        GROWTH_TRACE_COUNT(attractors_visited, end - chunk * chunk_size);
+
+        // the influencing pairs' coordinates, so their difference
+        // vectors can be computed in one batch
+        std::vector<node_id> nodes;
+        std::vector<scalar> ax, ay, nx, ny;
+
+        for (std::size_t i = chunk * chunk_size; i < end; ++i) {
+            std::size_t a = active[i];
+            if (!attractors_.alive(a)) {
+                continue;
+            }
+
+            // 1. associate every attractor with a growth node
+            update_nearest(a);
+            auto index = attractors_.nearest_node[a];
+            auto dist = attractors_.nearest_distance[a];
+
+            if (dist >= radius) {
+                // out of reach of every node until one grows close
+                attractors_.sleep(a);
+            } else if (dist > consume_radius_ * 0.01) {
+                buffer.attractors.push_back(a);
+                nodes.push_back(index);
+                ax.push_back(attractors_.x[a]);
+                ay.push_back(attractors_.y[a]);
+                nx.push_back(nodes_.x[index]);
+                ny.push_back(nodes_.y[index]);
+            }
+        }
+
+        // 2. the difference vector for each node
+        std::vector<scalar> dx(nodes.size());
+        std::vector<scalar> dy(nodes.size());
+        simd::directions(ax.data(), ay.data(), nx.data(), ny.data(), nodes.size(),
+            consume_radius_, dx.data(), dy.data());
+
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            buffer.influences.push_back(std::make_pair(nodes[i], vector2(dx[i], dy[i])));
+        }
+    });
+
+    attractors_.settle();
+    sleep_radius_ = std::min(sleep_radius_, radius);
+
+    // 2. sum the difference vectors for each node
+    std::map<unsigned int, vector2> influences;
+    std::vector<std::size_t> influencing_attractors;
+
+    for (const auto& buffer : buffers) {
+        for (const auto& i : buffer.influences) {
+            auto l = influences.find(i.first);
             if (l == influences.end()) {
-                influences[index] = d;
+                influences[i.first] = i.second;
             } else {
-                influences[index] = l->second + d;
+                influences[i.first] = l->second + i.second;
             }
         }
+
+        influencing_attractors.insert(influencing_attractors.end(),
+            buffer.attractors.begin(), buffer.attractors.end());
     }
 
+    lap(t, timings_.associate, trace::phase::associate);
+
     // 3 - 4
     grow(influences);
+    lap(t, timings_.grow, trace::phase::grow);
 
     // 5. remove attractors that have been consumed
-    for (const auto& a : influencing_attractors) {
-        auto vertex = nodes_graph_.nearest_vertex(a->point());
-        auto dst = util::distance(a->point(), vertex->point());
+    //
+    // This runs on the workers even if the index can't be shared. Every
+    // influencing attractor's nearest node was brought up to date above
+    // and growing only adds nodes to the index, so each one's cached node
+    // is still in it and update_nearest() only compares against the new
+    // nodes, never searching the index.
+    std::size_t num_influencing = influencing_attractors.size();
+    pool().parallel_for((num_influencing + chunk_size - 1) / chunk_size,
+        [&](std::size_t chunk) {
+            std::size_t end = std::min(num_influencing, (chunk + 1) * chunk_size);
+            for (std::size_t i = chunk * chunk_size; i < end; ++i) {
+                std::size_t a = influencing_attractors[i];
+                assert(attractors_.nearest_seen[a] != 0
+                    && nodes_index_->contains(attractors_.nearest_node[a]));
+                update_nearest(a);
+            }
+        });
 
-        if (dst < 0.001) {
-            attractors_graph_.remove(a);
+    for (const auto a : influencing_attractors) {
+        if (attractors_.nearest_distance[a] < 0.001) {
+            attractors_.remove(a);
+            GROWTH_TRACE_COUNT(attractors_removed, 1);
         }
     }
+
+    lap(t, timings_.consume, trace::phase::consume);
 }
 
 /**
  * Performs a single step of the closed venation algorithm.
  */
-void venation::closed_step() {
-    // 1. associate every attractor with the nearest growth nodes
-    std::map<unsigned int, venation::vector2> influences;
-    std::vector<
-        std::pair<venation::attractor_handle, std::vector<unsigned int>>
-    > influencing_attractors;
-    // find the relative neighborhood of each attractor
-    for (auto it = attractors_graph_.finite_vertices_begin();
-            it != attractors_graph_.finite_vertices_end(); ++it) {
-        auto s = it->point();
-        // add s to the nodes graph to quickly find neighbors
-        std::ptrdiff_t n = insert_node(s);
-        // auto s_handle = nodes_graph_.finite_vertices_end() - n;
-        auto s_handle = nodes_graph_.nearest_vertex(s);
-
-        // get the neighbors for comparison
-        std::vector<node_handle> adjacent;
-        auto nc = nodes_graph_.incident_vertices(s_handle);
-        auto done(nc);
-        
-        if (nc == 0) {
-            nodes_graph_.remove(s_handle);
-            continue;
-        }
-        
-        do {
-            adjacent.push_back(nc);
-        } while (++nc != done);
-
-        // find which neighbors are in the relative neighborhood
-        // and influence all of them
-        std::vector<unsigned int> influenced_node_ids;
-        for (const auto& v_handle : adjacent) {
-            auto v = v_handle->point();
-            auto v_s = util::distance(v, s);
-            bool valid = true;
-            
-            // point v is in the relative neighborhood if
-            // (u in V) ||v - s|| < max{||u - s||, ||v - u||}
-            for (const auto& u_handle : adjacent) {
-                auto u = u_handle->point();
-                if (u == v) {
-                    continue;
-                }
+template <typename Kernel>
+void basic_venation<Kernel>::closed_step() {
+    auto t = steady::now();
+
+    // As in open venation the attractors are split into chunks whose
+    // buffers are merged in order. The chunks only run in parallel if
+    // the index can be shared.
+    struct influence_buffer {
+        std::vector<std::pair<unsigned int, vector2>> influences;
+        std::vector<std::pair<std::size_t, std::vector<unsigned int>>> attractors;
+    };
 
-                auto u_s = util::distance(u, s);
-                auto v_u = util::distance(v, u);
-                
-                if (v_s >= std::max(u_s, v_u)) {
-                    valid = false;
-                    break;
-                }
+    const auto& active = attractors_.active();
+    std::size_t num_attractors = active.size();
+    std::size_t num_chunks = (num_attractors + chunk_size - 1) / chunk_size;
+    std::vector<influence_buffer> buffers(num_chunks);
+    scalar radius = growth_radius();
+
+    auto associate = [&](std::size_t chunk) {
+        auto& buffer = buffers[chunk];
+        std::size_t end = std::min(num_attractors, (chunk + 1) * chunk_size);
+        GROWTH_TRACE_COUNT(attractors_visited, end - chunk * chunk_size);
+
+        std::vector<unsigned int> neighbors;
+        std::vector<node_id> nodes;
+        std::vector<scalar> ax, ay, nx, ny;
+
+        for (std::size_t i = chunk * chunk_size; i < end; ++i) {
+            std::size_t a = active[i];
+            if (!attractors_.alive(a)) {
+                continue;
             }
 
-            if (!valid) {
+            // 1. associate every attractor with the growth nodes in
+            // its relative neighborhood
+            auto s = attractors_.position(a);
+            nodes_index_->relative_neighbors(s, radius, neighbors);
+            GROWTH_TRACE_COUNT(neighbor_queries, 1);
+
+            if (neighbors.empty()) {
+                // no node within the radius, so none will influence it
+                // until one grows close
+                attractors_.sleep(a);
                 continue;
             }
 
-            if (v_s > consume_radius_ * 0.01 && v_s < growth_radius()) {
-                // 2. sum the difference vectors for each node
-                influenced_node_ids.push_back(v_handle->info());
-                auto weight = std::max(consume_radius_, (long double)v_s);
-                venation::vector2 d = util::normalize(s - v) / weight;
-                auto id = v_handle->info();
-                auto l = influences.find(id);
-                if (l == influences.end()) {
-                    influences[id] = d;
-                } else {
-                    influences[id] = l->second + d;
+            std::vector<unsigned int> influenced_node_ids;
+            for (const auto v_id : neighbors) {
+                if (util::distance(s, nodes_.position(v_id)) > consume_radius_ * 0.01) {
+                    influenced_node_ids.push_back(v_id);
+                    nodes.push_back(v_id);
+                    ax.push_back(attractors_.x[a]);
+                    ay.push_back(attractors_.y[a]);
+                    nx.push_back(nodes_.x[v_id]);
+                    ny.push_back(nodes_.y[v_id]);
                 }
             }
+
+            if (influenced_node_ids.size() > 0) {
+                buffer.attractors.push_back(std::make_pair(a, influenced_node_ids));
+            }
         }
 
-        nodes_graph_.remove(s_handle);
+        // 2. the difference vector for each node
+        std::vector<scalar> dx(nodes.size());
+        std::vector<scalar> dy(nodes.size());
+        simd::directions(ax.data(), ay.data(), nx.data(), ny.data(), nodes.size(),
+            consume_radius_, dx.data(), dy.data());
+
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            buffer.influences.push_back(std::make_pair(nodes[i], vector2(dx[i], dy[i])));
+        }
+    };
+
+    if (nodes_index_->concurrent()) {
+        pool().parallel_for(num_chunks, associate);
+    } else {
+        for (std::size_t chunk = 0; chunk < num_chunks; ++chunk) {
+            associate(chunk);
+        }
+    }
+
+    attractors_.settle();
+    sleep_radius_ = std::min(sleep_radius_, radius);
+
+    // 2. sum the difference vectors for each node
+    std::map<unsigned int, vector2> influences;
+    std::vector<
+        std::pair<std::size_t, std::vector<unsigned int>>
+    > influencing_attractors;
 
-        if (influenced_node_ids.size() > 0) {
-            influencing_attractors.push_back(
-                std::make_pair(it, influenced_node_ids)
-            );
+    for (const auto& buffer : buffers) {
+        for (const auto& i : buffer.influences) {
+            auto l = influences.find(i.first);
+            if (l == influences.end()) {
+                influences[i.first] = i.second;
+            } else {
+                influences[i.first] = l->second + i.second;
+            }
         }
+
+        influencing_attractors.insert(influencing_attractors.end(),
+            buffer.attractors.begin(), buffer.attractors.end());
     }
 
+    lap(t, timings_.associate, trace::phase::associate);
+
     // 3 - 4
     grow(influences);
-    
+    lap(t, timings_.grow, trace::phase::grow);
+
     // 5. remove attractors that have been consumed
     for (const auto& pair : influencing_attractors) {
-        auto s = pair.first->point();
+        auto s = attractors_.position(pair.first);
         bool consumed = true;
         
         // check if every influenced node reached the attractor
@@ -418,97 +781,575 @@ void venation::closed_step() {
 
         // if consumed, remove the attractor
         if (consumed) {
-            attractors_graph_.remove(pair.first);  
+            attractors_.remove(pair.first);
+            GROWTH_TRACE_COUNT(attractors_removed, 1);
 
             // connect the two influenced nodes
             if (pair.second.size() == 2) {
-                auto& first = nodes_[pair.second[0]];
-                auto& second = nodes_[pair.second[1]];
-
-                if (first->children.size() > 0) {
-                    auto& last_child = first->children[first->children.size() - 1];
-                    auto dir = util::normalize(second->position - last_child->position);
-                    auto child_node = node::create(second->position, dir);
-                    last_child->children.push_back(child_node);
-                } else if (second->children.size() > 0) {
-                    auto& last_child = second->children[second->children.size() - 1];
-                    auto dir = util::normalize(first->position - last_child->position);
-                    auto child_node = node::create(first->position, dir);
-                    last_child->children.push_back(child_node);
+                node_id first = pair.second[0];
+                node_id second = pair.second[1];
+                auto first_position = nodes_.position(first);
+                auto second_position = nodes_.position(second);
+
+                // the connecting node is not indexed, it overlaps another
+                if (nodes_.has_children(first)) {
+                    node_id last_child = nodes_.last_child(first);
+                    auto dir = util::normalize(second_position - nodes_.position(last_child));
+                    create_node(second_position, dir, last_child);
+                } else if (nodes_.has_children(second)) {
+                    node_id last_child = nodes_.last_child(second);
+                    auto dir = util::normalize(first_position - nodes_.position(last_child));
+                    create_node(first_position, dir, last_child);
                 } else {
-                    auto dir = util::normalize(second->position - first->position);
-                    auto child_node = node::create(second->position, dir);
-                    first->children.push_back(child_node);
+                    auto dir = util::normalize(second_position - first_position);
+                    create_node(second_position, dir, first);
                 }
             }  
         }
     }
+
+    lap(t, timings_.consume, trace::phase::consume);
 }    
 
-void venation::update() {
-    if (mode_ == venation::type::open) {
+template <typename Kernel>
+void basic_venation<Kernel>::save(checkpoint& c) {
+    auto& p = c.params;
+    p.steps = steps_;
+    p.seed = seed_;
+    p.mode = static_cast<std::uint32_t>(mode_);
+    p.index = static_cast<std::uint32_t>(index_type_);
+    p.placement = static_cast<std::uint32_t>(placement_);
+    p.width = width_;
+    p.height = height_;
+    p.num_attractors = num_attractors_;
+    p.mask_shades = mask_shades_;
+    p.mask_given = mask_given_;
+    p.mask_width = mask_width_;
+    p.mask_height = mask_height_;
+    p.no_growth_limit = no_growth_limit_;
+    p.no_growth_count = no_growth_count_;
+    p.defer_pruning = defer_pruning_;
+    p.source_active = source_active_;
+    p.aspect_ratio = aspect_ratio_;
+    p.growth_radius = growth_radius_;
+    p.growth_rate = growth_rate_;
+    p.consume_radius = consume_radius_;
+    p.birth_radius = birth_radius_;
+    p.sleep_radius = sleep_radius_;
+    p.retire_radius = retire_radius_;
+
+    c.node_x = nodes_.x;
+    c.node_y = nodes_.y;
+    c.node_dx = nodes_.dx;
+    c.node_dy = nodes_.dy;
+    c.node_width = nodes_.width;
+    c.node_parent = nodes_.parent;
+    c.node_first_child = nodes_.first_child;
+    c.node_next_sibling = nodes_.next_sibling;
+    c.node_live = nodes_.live;
+
+    // only the live attractors, compaction keeps them in this order
+    c.attractor_x.clear();
+    c.attractor_y.clear();
+    c.attractor_dormant.clear();
+    c.attractor_nearest_node.clear();
+    c.attractor_nearest_distance.clear();
+    c.attractor_nearest_seen.clear();
+
+    for (std::size_t a = 0; a < attractors_.size(); ++a) {
+        if (!attractors_.alive(a)) {
+            continue;
+        }
+
+        c.attractor_x.push_back(attractors_.x[a]);
+        c.attractor_y.push_back(attractors_.y[a]);
+        c.attractor_dormant.push_back(attractors_.dormant[a]);
+        c.attractor_nearest_node.push_back(attractors_.nearest_node[a]);
+        c.attractor_nearest_distance.push_back(attractors_.nearest_distance[a]);
+        c.attractor_nearest_seen.push_back(attractors_.nearest_seen[a]);
+    }
+
+    c.seeds.clear();
+    for (const auto& seed : seeds_) {
+        c.seeds.push_back(seed.x());
+        c.seeds.push_back(seed.y());
+    }
+
+    c.prune_candidates.clear();
+    for (const auto& candidate : prune_candidates_) {
+        c.prune_candidates.push_back(candidate.first);
+        c.prune_candidates.push_back(candidate.second);
+    }
+
+    // pruned nodes linger in the front and archive until they are next
+    // scanned, but are already out of the index
+    auto live = [&](const std::vector<node_id>& ids) {
+        std::vector<node_id> kept;
+        std::copy_if(ids.begin(), ids.end(), std::back_inserter(kept),
+            [&](node_id n) { return nodes_.live[n]; });
+        return kept;
+    };
+
+    c.front = live(front_);
+    c.archive = live(archive_);
+    c.mask_data = mask_data_;
+}
+
+template <typename Kernel>
+void basic_venation<Kernel>::load(const checkpoint& c) {
+    // nothing is replaced unless all of it can be
+    auto problem = c.validate();
+    if (!problem.empty()) {
+        throw std::runtime_error("the checkpoint is corrupt, " + problem);
+    }
+
+    const auto& p = c.params;
+    steps_ = p.steps;
+    seed_ = p.seed;
+    mode_ = static_cast<type>(p.mode);
+    index_type_ = static_cast<index_type>(p.index);
+    placement_ = static_cast<placement_type>(p.placement);
+    width_ = p.width;
+    height_ = p.height;
+    num_attractors_ = p.num_attractors;
+    mask_shades_ = p.mask_shades;
+    mask_given_ = p.mask_given != 0;
+    mask_width_ = p.mask_width;
+    mask_height_ = p.mask_height;
+    no_growth_limit_ = p.no_growth_limit;
+    no_growth_count_ = p.no_growth_count;
+    defer_pruning_ = p.defer_pruning != 0;
+    source_active_ = p.source_active != 0 && source_ != nullptr;
+    aspect_ratio_ = p.aspect_ratio;
+    growth_radius_ = p.growth_radius;
+    growth_rate_ = p.growth_rate;
+    consume_radius_ = p.consume_radius;
+    birth_radius_ = p.birth_radius;
+    sleep_radius_ = p.sleep_radius;
+    retire_radius_ = p.retire_radius;
+    timings_ = phase_times();
+
+    // the image isn't kept, only what is drawn from it
+    mask_img_.reset();
+    mask_data_ = c.mask_data;
+    mask_table_ = mask_given_ ? alias_table(mask_data_) : alias_table();
+
+    nodes_.clear();
+    nodes_.x = c.node_x;
+    nodes_.y = c.node_y;
+    nodes_.dx = c.node_dx;
+    nodes_.dy = c.node_dy;
+    nodes_.width = c.node_width;
+    nodes_.parent = c.node_parent;
+    nodes_.first_child = c.node_first_child;
+    nodes_.next_sibling = c.node_next_sibling;
+    nodes_.live = c.node_live;
+    nodes_.relink();
+
+    std::vector<point2> points;
+    points.reserve(c.attractor_x.size());
+    for (std::size_t a = 0; a < c.attractor_x.size(); ++a) {
+        points.push_back(point2(c.attractor_x[a], c.attractor_y[a]));
+    }
+
+    attractors_.clear();
+    attractors_.insert(points);
+    attractors_.nearest_node = c.attractor_nearest_node;
+    attractors_.nearest_distance = c.attractor_nearest_distance;
+    attractors_.nearest_seen = c.attractor_nearest_seen;
+    attractors_.partition(-aspect_ratio_, -1.0, aspect_ratio_, 1.0, growth_radius_ / 4.0);
+
+    for (std::size_t a = 0; a < points.size(); ++a) {
+        if (c.attractor_dormant[a]) {
+            attractors_.sleep(a);
+        }
+    }
+
+    attractors_.settle();
+
+    seeds_.clear();
+    for (std::size_t i = 0; i + 1 < c.seeds.size(); i += 2) {
+        seeds_.push_back(point2(c.seeds[i], c.seeds[i + 1]));
+    }
+
+    prune_candidates_.clear();
+    for (std::size_t i = 0; i + 1 < c.prune_candidates.size(); i += 2) {
+        prune_candidates_.push_back(std::make_pair(c.prune_candidates[i],
+            c.prune_candidates[i + 1]));
+    }
+
+    // the front goes into the index as one batch, which the Delaunay
+    // index sorts spatially rather than inserting point by point
+    front_ = c.front;
+    archive_ = c.archive;
+    create_index();
+
+    std::vector<std::pair<point2, unsigned int>> entries;
+    entries.reserve(front_.size());
+    for (const auto n : front_) {
+        entries.push_back(std::make_pair(nodes_.position(n), n));
+    }
+
+    nodes_index_->insert(entries);
+}
+
+template <typename Kernel>
+bool basic_venation<Kernel>::converged() {
+    return !source_active_ && (attractors_.empty()
+        || no_growth_count_ > (int)no_growth_limit_);
+}
+
+template <typename Kernel>
+void basic_venation<Kernel>::update() {
+    ++steps_;
+    auto start = steady::now();
+    auto t = start;
+
+    if (source_active_) {
+        inject();
+    }
+
+    // the attractors put to sleep at a smaller radius may now be in reach
+    if (growth_radius() > sleep_radius_) {
+        attractors_.wake_all();
+        sleep_radius_ = std::numeric_limits<scalar>::infinity();
+    }
+
+    // as may the nodes retired at a smaller radius
+    if (growth_radius() > retire_radius_) {
+        restore();
+    }
+
+    attractors_.settle();
+    lap(t, timings_.maintain, trace::phase::maintain);
+
+    if (mode_ == type::open) {
         open_step();
-    } else if (mode_ == venation::type::closed) {
+    } else if (mode_ == type::closed) {
         closed_step();
     }
 
-    for (unsigned i = 0; i < seeds_.size(); ++i) {
-        std::vector<node_ref> removed = nodes_[i]->optimize();
-        
-        // remove pruned nodes from node graph
-        for (const auto& n : removed) {
-            auto vertex = nodes_graph_.nearest_vertex(n->position);
-            auto point = vertex->point();
+    t = steady::now();
+
+    if (!defer_pruning_) {
+        prune();
+    }
+
+    lap(t, timings_.prune, trace::phase::prune);
+
+    if (steps_ % retire_interval == 0) {
+        retire();
+    }
+
+    attractors_.compact();
+    lap(t, timings_.maintain, trace::phase::maintain);
+
+    if constexpr (trace::enabled) {
+        trace::record(trace::phase::step, start, t);
+    }
+
+    GROWTH_TRACE_STEP(steps_);
+}
+
+/**
+ * Prunes the straight lines that may have grown since the last step.
+ */
+template <typename Kernel>
+void basic_venation<Kernel>::prune() {
+    std::vector<node_id> removed;
+
+    for (const auto& candidate : prune_candidates_) {
+        nodes_.optimize(candidate.first, candidate.second, removed);
+    }
+
+    prune_candidates_.clear();
+    GROWTH_TRACE_COUNT(nodes_pruned, removed.size());
+
+    // remove pruned nodes from the spatial index
+    for (const auto n : removed) {
+        nodes_index_->remove(n);
+    }
+}
+
+/**
+ * Moves the nodes with no live attractor within the growth radius from
+ * the index to the archive. Attractors only associate with nodes closer
+ * than the radius, and one can't block another node from an attractor's
+ * relative neighborhood without being closer still, so until the radius
+ * grows the index only needs to hold the front.
+ */
+template <typename Kernel>
+void basic_venation<Kernel>::retire() {
+    scalar radius = growth_radius();
+    std::size_t j = 0;
+
+    for (const auto n : front_) {
+        // pruned nodes have already left the index
+        if (!nodes_.live[n]) {
+            continue;
+        }
+
+        if (attractors_.any_within(nodes_.x[n], nodes_.y[n], radius)) {
+            front_[j++] = n;
+        } else {
+            nodes_index_->remove(n);
+            archive_.push_back(n);
+            GROWTH_TRACE_COUNT(nodes_retired, 1);
+        }
+    }
+
+    front_.resize(j);
+    retire_radius_ = std::min(retire_radius_, radius);
+}
+
+/**
+ * Puts every retired node that has not been pruned back in the index.
+ */
+template <typename Kernel>
+void basic_venation<Kernel>::restore() {
+    std::vector<std::pair<point2, unsigned int>> points;
+
+    for (const auto n : archive_) {
+        if (nodes_.live[n]) {
+            points.push_back(std::make_pair(nodes_.position(n), n));
+            front_.push_back(n);
+        }
+    }
+
+    archive_.clear();
+    nodes_index_->insert(points);
+    retire_radius_ = std::numeric_limits<scalar>::infinity();
+}
+
+/**
+ * Puts the retired nodes that may be closer than radius to one of the
+ * points back in the index.
+ */
+template <typename Kernel>
+void basic_venation<Kernel>::restore_near(const std::vector<point2>& points,
+        scalar radius) {
+    if (archive_.empty() || points.empty()) {
+        return;
+    }
 
-            if (point == n->position) {
-                nodes_graph_.remove(vertex);
+    // the cells of a grid as wide as the radius holding a point, a node
+    // can only be within the radius of one in the cells around it
+    std::unordered_set<std::int64_t> occupied;
+    for (const auto& p : points) {
+        occupied.insert(cell_key(p.x(), p.y(), radius));
+    }
+
+    std::vector<std::pair<point2, unsigned int>> restored;
+    std::size_t j = 0;
+
+    for (const auto n : archive_) {
+        if (!nodes_.live[n]) {
+            continue;
+        }
+
+        bool near = false;
+        for (int dy = -1; dy <= 1 && !near; ++dy) {
+            for (int dx = -1; dx <= 1 && !near; ++dx) {
+                near = occupied.count(cell_key(nodes_.x[n], nodes_.y[n], radius, dx, dy)) > 0;
             }
         }
 
-        nodes_[i]->update_width();
+        if (near) {
+            restored.push_back(std::make_pair(nodes_.position(n), n));
+            front_.push_back(n);
+        } else {
+            archive_[j++] = n;
+        }
     }
+
+    archive_.resize(j);
+    nodes_index_->insert(restored);
 }
 
-void venation::draw_attractors() {
-    glPointSize(5.0f);
-    glBegin(GL_POINTS); 
-        glColor3f(1.0f, 0.0f, 0.0f);
-        for (auto it = attractors_graph_.finite_vertices_begin();
-                it != attractors_graph_.finite_vertices_end(); ++it) {
-            auto v = it->point();
-            glVertex2d(v.x() / aspect_ratio_, v.y());
+/**
+ * Adds the source's candidates for this step as attractors. Candidates in
+ * the black of the mask are dropped, then those closer than the birth
+ * radius to a node, a live attractor or an earlier kept candidate. The
+ * new attractors start the growth radius over from its base.
+ */
+template <typename Kernel>
+void basic_venation<Kernel>::inject() {
+    std::vector<point2> candidates;
+    source_active_ = source_->next(steps_, candidates);
+
+    std::vector<point2> points;
+    points.reserve(candidates.size());
+    int mask_width = mask_width_;
+    int mask_height = mask_height_;
+
+    for (const auto& c : candidates) {
+        scalar x = c.x() * aspect_ratio_;
+        scalar y = c.y();
+
+        if (mask_given_) {
+            int column = std::clamp((int)((c.x() + 1.0) / 2.0 * mask_width), 0, mask_width - 1);
+            int row = std::clamp((int)((1.0 - c.y()) / 2.0 * mask_height), 0, mask_height - 1);
+            if (mask_data_[row * mask_width + column] <= 0.0f) {
+                continue;
+            }
+        }
+
+        points.push_back(point2(x, y));
+    }
+
+    if (points.empty()) {
+        return;
+    }
+
+    // Retired nodes near the candidates are searched again, both to
+    // reject candidates and for the new attractors to find them.
+    restore_near(points, std::max(growth_radius(), birth_radius_));
+
+    scalar radius = birth_radius_;
+    std::vector<std::uint8_t> rejected(points.size(), 0);
+
+    if (radius > 0) {
+        unsigned int id;
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            if (nodes_index_->nearest(points[i], radius, id)
+                    && util::distance(points[i], nodes_.position(id)) < radius) {
+                rejected[i] = 1;
+            }
+        }
+
+        // the candidates bucketed by cells as wide as the radius
+        std::unordered_map<std::int64_t, std::vector<std::size_t>> cells;
+        bool crowded = false;
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            if (!rejected[i]) {
+                cells[cell_key(points[i].x(), points[i].y(), radius)].push_back(i);
+                crowded = crowded || attractors_.any_within(points[i].x(), points[i].y(), radius);
+            }
+        }
+
+        // the candidates near each other within the cells around p
+        auto near = [&](scalar px, scalar py, auto&& visit) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    auto cell = cells.find(cell_key(px, py, radius, dx, dy));
+                    if (cell == cells.end()) {
+                        continue;
+                    }
+
+                    for (const auto i : cell->second) {
+                        scalar ex = points[i].x() - px;
+                        scalar ey = points[i].y() - py;
+                        if (ex * ex + ey * ey < radius * radius) {
+                            visit(i);
+                        }
+                    }
+                }
+            }
+        };
+
+        // Only when the attractor grid has any in reach are the live
+        // attractors compared against the candidates, in chunks each
+        // noting the candidates it rules out.
+        if (crowded) {
+            std::size_t count = attractors_.size();
+            std::size_t num_chunks = (count + chunk_size - 1) / chunk_size;
+            std::vector<std::vector<std::size_t>> hits(num_chunks);
+
+            pool().parallel_for(num_chunks, [&](std::size_t chunk) {
+                std::size_t end = std::min(count, (chunk + 1) * chunk_size);
+                for (std::size_t a = chunk * chunk_size; a < end; ++a) {
+                    if (attractors_.alive(a)) {
+                        near(attractors_.x[a], attractors_.y[a], [&](std::size_t i) {
+                            hits[chunk].push_back(i);
+                        });
+                    }
+                }
+            });
+
+            for (const auto& chunk : hits) {
+                for (const auto i : chunk) {
+                    rejected[i] = 1;
+                }
+            }
+        }
+
+        // the earlier candidates that are kept win over later ones
+        for (std::size_t i = 0; i < points.size(); ++i) {
+            if (rejected[i]) {
+                continue;
+            }
+
+            near(points[i].x(), points[i].y(), [&](std::size_t k) {
+                if (k < i && !rejected[k]) {
+                    rejected[i] = 1;
+                }
+            });
         }
-    glEnd();
+    }
+
+    std::vector<point2> accepted;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        if (!rejected[i]) {
+            accepted.push_back(points[i]);
+        }
+    }
+
+    if (accepted.empty()) {
+        return;
+    }
+
+    attractors_.insert(accepted);
+    GROWTH_TRACE_COUNT(attractors_added, accepted.size());
+    no_growth_count_ = 0;
 }
 
-void venation::draw_nodes() {
-    // start at each seed
+template <typename Kernel>
+void basic_venation<Kernel>::optimize() {
     for (unsigned i = 0; i < seeds_.size(); ++i) {
-        // initialize a stack of nodes
-        std::vector<node_ref> to_visit;
-        to_visit.push_back(nodes_[i]);
-
-        glColor3f(1.0f, 1.0f, 1.0f);
-        glLineWidth(3.0f);
-
-        // while the stack is not empty
-        while (to_visit.size() > 0) {
-            // pop from the stack
-            auto node = to_visit.back();
-            to_visit.pop_back();
-
-            // visit each of the node's children
-            for (auto child : node->children) {
-                // push them to the stack
-                to_visit.push_back(child);
-
-                // draw a line from the parent to the child
-                glLineWidth(child->width * 3.0);
-                glBegin(GL_LINES);
-                    glVertex2d(node->position.x() / aspect_ratio_, node->position.y());
-                    glVertex2d(child->position.x() / aspect_ratio_, child->position.y());
-                glEnd();
-            }
+        for (const auto n : nodes_.optimize(i)) {
+            nodes_index_->remove(n);
+            GROWTH_TRACE_COUNT(nodes_pruned, 1);
+        }
+    }
+
+    prune_candidates_.clear();
+}
+
+template <typename Kernel>
+void basic_venation<Kernel>::capture(snapshot& s, bool with_attractors) {
+    s.segments.clear();
+    s.widths.clear();
+    s.attractors.clear();
+    s.aspect_ratio = aspect_ratio_;
+    s.steps = steps_;
+
+    // every node in the tree other than the seeds ends a line
+    for (node_id n = 0; n < nodes_.size(); ++n) {
+        node_id parent = nodes_.parent[n];
+        if (!nodes_.live[n] || parent == no_node) {
+            continue;
+        }
+
+        s.segments.insert(s.segments.end(), {
+            (float)nodes_.x[parent], (float)nodes_.y[parent],
+            (float)nodes_.x[n], (float)nodes_.y[n]
+        });
+        s.widths.push_back(nodes_.width[n]);
+    }
+
+    if (!with_attractors) {
+        return;
+    }
+
+    // dormant attractors are drawn too
+    for (std::size_t a = 0; a < attractors_.size(); ++a) {
+        if (attractors_.alive(a)) {
+            s.attractors.push_back(attractors_.x[a]);
+            s.attractors.push_back(attractors_.y[a]);
         }
     }
 }
+
+template class growth::basic_venation<growth::float_kernel>;
+template class growth::basic_venation<growth::double_kernel>;
+template class growth::basic_venation<growth::cgal_kernel>;